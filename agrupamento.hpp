@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <omp.h>
+#include "welford.hpp"
+#include "esboco_quantis.hpp"
+
+// Estatísticas de um grupo (contagem, soma, Welford, mínimo, máximo e, opcionalmente,
+// um esboço KLL para os percentis do grupo)
+struct EstatisticaGrupo {
+    double soma;
+    WelfordAccumulator welford;
+    double minimo;
+    double maximo;
+    EsbocoQuantis esboco;
+
+    explicit EstatisticaGrupo(int kEsboco = 0)
+        : soma(0.0),
+          minimo(std::numeric_limits<double>::max()),
+          maximo(std::numeric_limits<double>::lowest()),
+          esboco(kEsboco) {}
+
+    long long contagem() const { return welford.count; }
+    double media() const { return welford.count > 0 ? welford.mean : 0.0; }
+    double desvio_amostral() const {
+        return welford.count > 1 ? std::sqrt(welford.M2 / (welford.count - 1)) : 0.0;
+    }
+    double amplitude() const { return welford.count > 0 ? maximo - minimo : 0.0; }
+};
+
+inline void grupo_combinar(EstatisticaGrupo& a, const EstatisticaGrupo& b) {
+    a.soma += b.soma;
+    welford_combine(a.welford, b.welford);
+    a.minimo = std::min(a.minimo, b.minimo);
+    a.maximo = std::max(a.maximo, b.maximo);
+    a.esboco.combinar(b.esboco);
+}
+
+// Group-by paralelo para chaves inteiras pequenas (ou códigos de dicionário) em [0, numChaves).
+// Cada thread acumula sua faixa estática em um vetor denso privado, indexado pela chave;
+// depois cada chave é combinada por uma thread, percorrendo as parciais em ordem de thread.
+// Não há travas, e o resultado não depende do escalonamento. Chaves fora do intervalo são ignoradas.
+// Com kEsboco > 0 cada grupo também ganha um esboço KLL (percentis por grupo na mesma passada).
+template <typename Chave>
+std::vector<EstatisticaGrupo> agrupar(const Chave* chaves, const double* valores, size_t n, int numChaves,
+                                      int kEsboco = 0) {
+    const int maxThreads = omp_get_max_threads();
+    std::vector<EstatisticaGrupo> parciais(static_cast<size_t>(maxThreads) * numChaves, EstatisticaGrupo(kEsboco));
+    std::vector<EstatisticaGrupo> grupos(numChaves, EstatisticaGrupo(kEsboco));
+
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        const int t = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const size_t ini = n * t / nt;
+        const size_t fim = n * (t + 1) / nt;
+        EstatisticaGrupo* locais = &parciais[static_cast<size_t>(t) * numChaves];
+
+        for (size_t i = ini; i < fim; ++i) {
+            const long long k = static_cast<long long>(chaves[i]);
+            if (k < 0 || k >= numChaves) continue;
+            EstatisticaGrupo& g = locais[k];
+            const double x = valores[i];
+            g.soma += x;
+            welford_update(g.welford, x);
+            if (x < g.minimo) g.minimo = x;
+            if (x > g.maximo) g.maximo = x;
+            g.esboco.adicionar(x);
+        }
+
+        #pragma omp barrier
+
+        #pragma omp for schedule(static)
+        for (int k = 0; k < numChaves; ++k) {
+            for (int th = 0; th < nt; ++th) {
+                grupo_combinar(grupos[k], parciais[static_cast<size_t>(th) * numChaves + k]);
+            }
+        }
+    }
+
+    return grupos;
+}
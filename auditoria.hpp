@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "funcionarios.hpp"
+#include "compensado.hpp"
+#include "predicados.hpp"
+
+// Bits da máscara de violações de cada funcionário
+enum BitViolacao : uint8_t {
+    VIOLA_PISO = 1 << 0,
+    VIOLA_TETO = 1 << 1,
+    VIOLA_IDADE = 1 << 2,
+    VIOLA_HORAS = 1 << 3,
+    DADO_INVALIDO = 1 << 4,           // salário, idade ou horas <= 0
+    SALARIO_INCONSISTENTE = 1 << 5    // fora da margem esperada para o departamento
+};
+
+// Regras contadas em "múltiplas violações"
+const uint8_t VIOLACOES_DE_REGRA = VIOLA_PISO | VIOLA_TETO | VIOLA_IDADE | VIOLA_HORAS;
+
+// CONSTANTES DE NEGÓCIO
+struct RegrasAuditoria {
+    double piso_salarial = 1500.0;
+    double teto_salarial = 20000.0;
+    int idade_minima = 18;
+    int idade_maxima = 70;
+    double horas_minimas = 80.0;
+    double horas_maximas = 220.0;
+    double margem_departamento = 0.3; // 30% em torno de 3000 + departamento * 500
+};
+
+struct ResultadoAuditoria {
+    std::vector<uint8_t> mascara; // uma máscara BitViolacao por funcionário
+
+    long long violacoes_piso = 0;
+    long long violacoes_teto = 0;
+    long long violacoes_idade = 0;
+    long long violacoes_horas = 0;
+    long long violacoes_multiplas = 0;
+    long long dados_invalidos = 0;
+    long long salarios_inconsistentes = 0;
+
+    double menor_salario = std::numeric_limits<double>::max();
+    double maior_salario = std::numeric_limits<double>::lowest();
+    MomentosCompensados momentos_salario; // Σs e Σs² compensados: média e variância estáveis em uma passada
+
+    // Flags dos relatórios de q3.cpp, derivadas das contagens
+    bool piso_violado() const { return violacoes_piso > 0; }
+    bool teto_violado() const { return violacoes_teto > 0; }
+    bool dados_validos() const { return dados_invalidos == 0; }
+    bool salarios_consistentes() const { return salarios_inconsistentes == 0; }
+    bool horas_consistentes() const { return violacoes_horas == 0; }
+
+    // Primeiro funcionário com algum dos bits (NAO_ENCONTRADO se nenhum): lê só a máscara, um
+    // byte por funcionário, e para na primeira testemunha
+    size_t primeiro_com(uint8_t bits) const {
+        return encontrar_primeiro(mascara.data(), mascara.size(), [bits](uint8_t m) { return (m & bits) != 0; });
+    }
+};
+
+// Avalia todas as regras em uma única passada sobre as colunas.
+// O corpo não tem desvios (cada regra vira um bit), então o laço vetoriza. A passada anda
+// em blocos de BLOCO_COMPENSADO: os momentos compensados do salário são acumulados logo
+// depois das regras, com o bloco ainda na L1.
+inline ResultadoAuditoria auditar(const TabelaFuncionarios& tabela, const RegrasAuditoria& regras = {}) {
+    const long long n = static_cast<long long>(tabela.tamanho());
+    const double* salario = tabela.salario.data();
+    const int* departamento = tabela.departamento.data();
+    const int* idade = tabela.idade.data();
+    const double* horas = tabela.horas_trabalhadas.data();
+
+    ResultadoAuditoria r;
+    r.mascara.resize(n);
+    uint8_t* mascara = r.mascara.data();
+
+    long long piso = 0, teto = 0, faixa_idade = 0, faixa_horas = 0, multiplas = 0;
+    long long invalidos = 0, inconsistentes = 0;
+    double menor = r.menor_salario, maior = r.maior_salario;
+    MomentosCompensados momentos;
+    const long long bloco = static_cast<long long>(BLOCO_COMPENSADO);
+
+    #pragma omp parallel for schedule(static) \
+        reduction(+:piso, teto, faixa_idade, faixa_horas, multiplas, invalidos, inconsistentes) \
+        reduction(min:menor) reduction(max:maior) reduction(momentos_compensados:momentos)
+    for (long long inicio = 0; inicio < n; inicio += bloco) {
+        const long long fim = (n - inicio < bloco) ? n : inicio + bloco;
+        #pragma omp simd reduction(+:piso, teto, faixa_idade, faixa_horas, multiplas, invalidos, inconsistentes) \
+            reduction(min:menor) reduction(max:maior)
+        for (long long i = inicio; i < fim; ++i) {
+            const double s = salario[i];
+            const double h = horas[i];
+            const int a = idade[i];
+            const double esperado = 3000.0 + departamento[i] * 500.0;
+
+            uint8_t m = 0;
+            m |= (s < regras.piso_salarial) ? VIOLA_PISO : 0;
+            m |= (s > regras.teto_salarial) ? VIOLA_TETO : 0;
+            m |= (a < regras.idade_minima || a > regras.idade_maxima) ? VIOLA_IDADE : 0;
+            m |= (h < regras.horas_minimas || h > regras.horas_maximas) ? VIOLA_HORAS : 0;
+            m |= (s <= 0 || a <= 0 || h <= 0) ? DADO_INVALIDO : 0;
+            m |= (std::fabs(s - esperado) > esperado * regras.margem_departamento) ? SALARIO_INCONSISTENTE : 0;
+            mascara[i] = m;
+
+            piso += (m & VIOLA_PISO) != 0;
+            teto += (m & VIOLA_TETO) != 0;
+            faixa_idade += (m & VIOLA_IDADE) != 0;
+            faixa_horas += (m & VIOLA_HORAS) != 0;
+            invalidos += (m & DADO_INVALIDO) != 0;
+            inconsistentes += (m & SALARIO_INCONSISTENTE) != 0;
+
+            // Dois ou mais bits de regra: removendo o bit mais baixo ainda sobra algum
+            const uint8_t regra = m & VIOLACOES_DE_REGRA;
+            multiplas += (regra & (regra - 1)) != 0;
+
+            menor = s < menor ? s : menor;
+            maior = s > maior ? s : maior;
+        }
+        momentos.adicionar_bloco(salario + inicio, static_cast<size_t>(fim - inicio));
+    }
+
+    r.violacoes_piso = piso;
+    r.violacoes_teto = teto;
+    r.violacoes_idade = faixa_idade;
+    r.violacoes_horas = faixa_horas;
+    r.violacoes_multiplas = multiplas;
+    r.dados_invalidos = invalidos;
+    r.salarios_inconsistentes = inconsistentes;
+    r.menor_salario = menor;
+    r.maior_salario = maior;
+    r.momentos_salario = momentos;
+    return r;
+}
+
+// Respostas sim/não da auditoria básica com saída antecipada: cada flag para na primeira
+// testemunha, que também é devolvida (NAO_ENCONTRADO quando a regra não é violada).
+// Substitui auditar() quando só as respostas interessam; depois de auditar(), as mesmas
+// testemunhas saem mais barato de ResultadoAuditoria::primeiro_com.
+struct VerificacaoRapida {
+    size_t primeiro_abaixo_piso = NAO_ENCONTRADO;
+    size_t primeiro_acima_teto = NAO_ENCONTRADO;
+    size_t primeiro_invalido = NAO_ENCONTRADO;
+
+    bool piso_violado() const { return primeiro_abaixo_piso != NAO_ENCONTRADO; }
+    bool teto_violado() const { return primeiro_acima_teto != NAO_ENCONTRADO; }
+    bool dados_validos() const { return primeiro_invalido == NAO_ENCONTRADO; }
+};
+
+inline VerificacaoRapida verificar_rapido(const TabelaFuncionarios& tabela, const RegrasAuditoria& regras = {}) {
+    const size_t n = tabela.tamanho();
+    const double* salario = tabela.salario.data();
+    const int* idade = tabela.idade.data();
+    const double* horas = tabela.horas_trabalhadas.data();
+
+    VerificacaoRapida v;
+    v.primeiro_abaixo_piso = encontrar_primeiro(salario, n, [&](double s) { return s < regras.piso_salarial; });
+    v.primeiro_acima_teto = encontrar_primeiro(salario, n, [&](double s) { return s > regras.teto_salarial; });
+    v.primeiro_invalido = encontrar_primeiro_indice(n, [=](size_t i) {
+        return salario[i] <= 0 || idade[i] <= 0 || horas[i] <= 0;
+    });
+    return v;
+}
+
+// Conta salários com |z| > limiar. O maior |z| está sempre no menor ou no maior salário,
+// já obtidos na passada da auditoria: se nenhum dos dois passa do limiar, não há anomalias
+// e a segunda leitura da coluna é dispensada.
+inline long long contar_anomalias_zscore(const TabelaFuncionarios& tabela, const ResultadoAuditoria& r,
+                                         double media, double desvio_padrao, double limiar = 3.0) {
+    auto z = [&](double s) { return std::fabs((s - media) / desvio_padrao); };
+    if (!(z(r.menor_salario) > limiar) && !(z(r.maior_salario) > limiar)) {
+        return 0;
+    }
+
+    const long long n = static_cast<long long>(tabela.tamanho());
+    const double* salario = tabela.salario.data();
+    long long anomalias = 0;
+    #pragma omp parallel for simd reduction(+:anomalias)
+    for (long long i = 0; i < n; ++i) {
+        anomalias += z(salario[i]) > limiar;
+    }
+    return anomalias;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+// Ajuste automático de laços de redução: decide se vale abrir uma região paralela, com
+// quantas threads, e qual schedule/chunk usar, a partir de custos medidos na máquina.
+//
+// A calibração mede uma vez:
+//   - fork/join de uma região paralela vazia com todas as threads
+//   - despacho de um chunk em schedule(dynamic)
+//   - custo por elemento de uma soma de doubles lida da memória (laço de referência)
+// e grava o resultado num arquivo de cache (OMP_AJUSTE_CACHE, ou
+// ~/.cache/omp_reduction_ajuste-<host>.txt), reaproveitado enquanto a máquina (hostname e
+// modelo da CPU) e o número de threads não mudarem. Com o $HOME compartilhado entre máquinas,
+// cada host tem seu arquivo, e um cache de outra máquina é medido de novo.
+//
+// O número de threads (e se vale paralelizar) é sempre decidido pela calibração. O schedule é
+// opt-in: só laços marcados `irregular` (custo variável por iteração) ganham dynamic com chunk
+// calculado; os demais ficam em static sem chunk, que para custo uniforme é o melhor schedule e
+// mantém cada thread na faixa contígua cujas páginas ela tocou primeiro (BufferNuma).
+//
+// Uso num laço:
+//   PlanoLaco p = planejar(n);              // ou planejar(n, custo, true) para laços irregulares
+//   aplicar(p);
+//   #pragma omp parallel for if(p.paralelo) num_threads(p.threads) schedule(runtime) reduction(+:s)
+struct CalibracaoHost {
+    int threads = 0;
+    double fork_join_s = 0.0;        // região paralela vazia com `threads` threads
+    double despacho_chunk_s = 0.0;   // custo de pegar um chunk em schedule(dynamic)
+    double custo_elemento_s = 0.0;   // soma de um double vindo da memória, serial
+};
+
+struct PlanoLaco {
+    bool paralelo = false;
+    int threads = 1;
+    omp_sched_t schedule = omp_sched_static;
+    int chunk = 0;  // 0: padrão do schedule
+    double tempo_estimado_s = 0.0;
+};
+
+namespace detalhe_ajuste {
+
+const int VERSAO_CACHE = 2;
+
+inline std::string nome_host() {
+    char nome[256] = {};
+    if (gethostname(nome, sizeof(nome) - 1) != 0 || nome[0] == '\0') return "desconhecido";
+    return nome;
+}
+
+// "model name" de /proc/cpuinfo (a primeira CPU basta: os custos medidos são da máquina toda)
+inline std::string modelo_cpu() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string linha;
+    while (std::getline(in, linha)) {
+        if (linha.compare(0, 10, "model name") != 0) continue;
+        size_t inicio = linha.find(':');
+        if (inicio == std::string::npos) break;
+        inicio = linha.find_first_not_of(' ', inicio + 1);
+        return inicio == std::string::npos ? std::string() : linha.substr(inicio);
+    }
+    return "desconhecido";
+}
+
+// Chave da calibração: os custos só valem na máquina que os mediu
+inline std::string identificacao_maquina() {
+    return nome_host() + " | " + modelo_cpu();
+}
+
+inline std::string caminho_cache() {
+    if (const char* caminho = std::getenv("OMP_AJUSTE_CACHE")) return caminho;
+    const std::string arquivo = "omp_reduction_ajuste-" + nome_host() + ".txt";
+    if (const char* home = std::getenv("HOME")) return std::string(home) + "/.cache/" + arquivo;
+    return "." + arquivo;
+}
+
+// Formato: "versão threads fork_join despacho custo" e, na segunda linha, a identificação da máquina
+inline bool ler_cache(const std::string& caminho, const std::string& maquina, int threads, CalibracaoHost& c) {
+    std::ifstream in(caminho);
+    int versao = 0;
+    if (!(in >> versao >> c.threads >> c.fork_join_s >> c.despacho_chunk_s >> c.custo_elemento_s)) return false;
+    std::string lida;
+    in >> std::ws;
+    if (!std::getline(in, lida)) return false;
+    return versao == VERSAO_CACHE && lida == maquina && c.threads == threads && c.custo_elemento_s > 0.0;
+}
+
+// Cria os diretórios de `caminho` que faltam (como mkdir -p no diretório do arquivo)
+inline void criar_diretorios(const std::string& caminho) {
+    for (size_t barra = caminho.find('/', 1); barra != std::string::npos; barra = caminho.find('/', barra + 1)) {
+        mkdir(caminho.substr(0, barra).c_str(), 0755);  // EEXIST nos que já existem
+    }
+}
+
+// Sem cache gravado a próxima execução recalibra; a falha é avisada para não passar despercebida
+inline void gravar_cache(const std::string& caminho, const std::string& maquina, const CalibracaoHost& c) {
+    criar_diretorios(caminho);
+    std::ofstream out(caminho);
+    out.precision(17);
+    out << VERSAO_CACHE << ' ' << c.threads << ' ' << c.fork_join_s << ' ' << c.despacho_chunk_s << ' '
+        << c.custo_elemento_s << '\n' << maquina << '\n';
+    out.close();
+    if (!out) {
+        std::cerr << "aviso: não foi possível gravar a calibração em " << caminho
+                  << " (defina OMP_AJUSTE_CACHE); ela será medida de novo na próxima execução\n";
+    }
+}
+
+// Mediana de `repeticoes` medições de f()
+template <typename Funcao>
+double mediana_tempo(int repeticoes, Funcao f) {
+    std::vector<double> tempos(repeticoes);
+    for (double& t : tempos) {
+        double inicio = omp_get_wtime();
+        f();
+        t = omp_get_wtime() - inicio;
+    }
+    std::nth_element(tempos.begin(), tempos.begin() + repeticoes / 2, tempos.end());
+    return tempos[repeticoes / 2];
+}
+
+inline CalibracaoHost medir(int threads) {
+    CalibracaoHost c;
+    c.threads = threads;
+
+    // Fork/join: mediana de regiões vazias, agrupadas de 16 em 16 para sair da resolução do relógio
+    c.fork_join_s = mediana_tempo(21, [threads] {
+        for (int r = 0; r < 16; ++r) {
+            #pragma omp parallel num_threads(threads)
+            {
+                asm volatile("" ::: "memory");
+            }
+        }
+    }) / 16;
+
+    // Despacho dinâmico: 64k iterações vazias com chunk 1, descontado o fork/join
+    const int iteracoes = 1 << 16;
+    double dinamico = mediana_tempo(5, [threads, iteracoes] {
+        #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (int i = 0; i < iteracoes; ++i) {
+            asm volatile("" ::: "memory");
+        }
+    });
+    c.despacho_chunk_s = std::max(0.0, dinamico - c.fork_join_s) * threads / iteracoes;
+
+    // Custo por elemento: soma serial de 32 MB (maior que a cache, como os laços de q1-q4)
+    std::vector<double> buffer(size_t(1) << 22, 1.0);
+    volatile double sumidouro = 0.0;
+    double streaming = mediana_tempo(5, [&] {
+        double s = 0.0;
+        for (double v : buffer) s += v;
+        sumidouro = s;
+    });
+    (void)sumidouro;
+    c.custo_elemento_s = streaming / buffer.size();
+    return c;
+}
+
+} // namespace detalhe_ajuste
+
+// Calibração da máquina: medida na primeira chamada ou lida do cache
+inline const CalibracaoHost& calibracao() {
+    static const CalibracaoHost c = [] {
+        const int threads = omp_get_max_threads();
+        const std::string caminho = detalhe_ajuste::caminho_cache();
+        const std::string maquina = detalhe_ajuste::identificacao_maquina();
+        CalibracaoHost lida;
+        if (detalhe_ajuste::ler_cache(caminho, maquina, threads, lida)) return lida;
+        CalibracaoHost medida = detalhe_ajuste::medir(threads);
+        detalhe_ajuste::gravar_cache(caminho, maquina, medida);
+        return medida;
+    }();
+    return c;
+}
+
+// Plano para n iterações de custo `custo_relativo` vezes o laço de referência. Sem
+// `irregular` o schedule é sempre static (chunk 0); com ele, o custo varia entre iterações e o
+// plano usa schedule dinâmico com chunk grande o bastante para diluir o despacho.
+//
+// Modelo: tempo(t) = trabalho / t + fork_join · t / T, onde T é o número de threads
+// calibrado. O fork/join cresce com as threads acordadas, então laços pequenos param
+// em poucas threads ou ficam seriais (t = 1, sem região paralela).
+inline PlanoLaco planejar(size_t n, double custo_relativo = 1.0, bool irregular = false) {
+    const CalibracaoHost& c = calibracao();
+    const double trabalho = static_cast<double>(n) * c.custo_elemento_s * custo_relativo;
+
+    PlanoLaco p;
+    p.tempo_estimado_s = trabalho;
+    for (int t = 2; t <= c.threads; ++t) {
+        double estimado = trabalho / t + c.fork_join_s * t / c.threads;
+        if (estimado < p.tempo_estimado_s) {
+            p.tempo_estimado_s = estimado;
+            p.threads = t;
+        }
+    }
+    p.paralelo = p.threads > 1;
+
+    if (irregular && p.paralelo) {
+        // Despacho abaixo de ~5% do chunk, e pelo menos 4 chunks por thread para balancear
+        const double custo_iteracao = c.custo_elemento_s * custo_relativo;
+        size_t chunk = static_cast<size_t>(20.0 * c.despacho_chunk_s / custo_iteracao) + 1;
+        chunk = std::min(chunk, std::max<size_t>(1, n / (4 * static_cast<size_t>(p.threads))));
+        p.schedule = omp_sched_dynamic;
+        p.chunk = static_cast<int>(chunk);
+    }
+    return p;
+}
+
+// Define o schedule usado por schedule(runtime) na thread que vai abrir a região
+inline void aplicar(const PlanoLaco& p) {
+    omp_set_schedule(p.schedule, p.chunk);
+}
+
+inline std::string descrever(const PlanoLaco& p) {
+    if (!p.paralelo) return "serial";
+    std::string texto = std::to_string(p.threads) + " threads, ";
+    texto += p.schedule == omp_sched_dynamic ? "dynamic" : "static";
+    if (p.chunk > 0) texto += "," + std::to_string(p.chunk);
+    return texto;
+}
@@ -0,0 +1,569 @@
+// Suíte de benchmarks das reduções de q1-q4.
+//
+// Varre tamanho dos dados, número de threads e tipo de schedule; cada medição tem
+// aquecimento e repetições, e o relatório (JSON) traz mediana, percentis, GB/s e
+// eficiência paralela em relação à menor contagem de threads medida.
+//
+// Compilação: g++ -std=c++17 -O2 -fopenmp bench.cpp -o bench
+// Uso:        ./bench [--tamanhos 100000,1000000] [--threads 1,2,4] [--schedules static,dynamic:1024,guided]
+//                     [--repeticoes 11] [--aquecimento 2] [--semente 42] [--saida resultado.json]
+//                     [--kernels soma,welford] [--afinidade compacta|espalhada|nenhuma] [--contadores 1]
+//
+// Escalonamento entre soquetes: os kernels de origem "numa" somam o mesmo vetor com as
+// páginas no nó da thread principal e com primeiro toque paralelo (BufferNuma). Com
+// --afinidade compacta as threads enchem um soquete antes do próximo:
+//   ./bench --kernels soma_toque_serial,soma_toque_paralelo --threads 1,2,4,8,16,32 --afinidade compacta
+//
+// Com --contadores 1 cada medição ganha uma execução extra sob perf_event_open (contadores.hpp):
+// IPC, bytes trazidos da DRAM por elemento (falhas da LLC × 64) e banda atingida em relação à
+// banda de leitura de pico medida no início. Sem PMU (máquina virtual) ou sem permissão
+// (perf_event_paranoid), os campos saem null e só o tempo de CPU é registrado.
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <omp.h>
+#include "philox.hpp"
+#include "welford.hpp"
+#include "estatisticas.hpp"
+#include "quantis.hpp"
+#include "esboco_quantis.hpp"
+#include "funcionarios.hpp"
+#include "auditoria.hpp"
+#include "agrupamento.hpp"
+#include "centavos.hpp"
+#include "soma_reprodutivel.hpp"
+#include "compensado.hpp"
+#include "predicados.hpp"
+#include "kernels_isa.hpp"
+#include "numa.hpp"
+#include "contadores.hpp"
+#include "ordenacao_radix.hpp"
+
+// Evita que o compilador descarte o resultado dos kernels
+static volatile double sumidouro = 0.0;
+
+struct Configuracao {
+    std::vector<size_t> tamanhos = {100000, 1000000, 10000000};
+    std::vector<int> threads;
+    std::vector<std::string> schedules = {"static", "dynamic:1024", "guided"}; // tipo[:chunk]
+    int repeticoes = 11;
+    int aquecimento = 2;
+    uint64_t semente = 42;
+    std::string saida;
+    std::vector<std::string> kernels;  // vazio: todos
+    PoliticaAfinidade afinidade = politica_do_ambiente();
+    bool contadores = false;
+};
+
+struct Kernel {
+    std::string nome;
+    std::string origem;          // programa de onde o kernel vem
+    double bytes_por_elemento;   // bytes lidos por elemento (para GB/s)
+    bool usa_schedule;           // laço com schedule(runtime); senão o schedule é interno
+    size_t tamanho_maximo;       // kernels lentos por natureza (critical) ficam limitados
+    std::function<double(size_t)> executar;
+};
+
+struct Medicao {
+    std::string kernel, origem, schedule;
+    size_t n;
+    int threads;
+    double mediana, p10, p90, minimo, gbs, eficiencia;
+    bool tem_contadores = false;
+    MedicaoContadores contadores;
+};
+
+// Dados de entrada, gerados uma vez para o maior tamanho (cada kernel usa o prefixo de n)
+struct Dados {
+    std::vector<double> salarios;
+    std::vector<int> inteiros;
+    ColunaCentavos centavos;
+    TabelaFuncionarios funcionarios;
+    SeletorQuantis seletor;
+};
+
+static std::vector<std::string> dividir(const std::string& texto) {
+    std::vector<std::string> partes;
+    std::stringstream ss(texto);
+    std::string parte;
+    while (std::getline(ss, parte, ',')) {
+        if (!parte.empty()) partes.push_back(parte);
+    }
+    return partes;
+}
+
+static Configuracao ler_argumentos(int argc, char* argv[]) {
+    Configuracao cfg;
+    for (int i = 1; i < argc; i += 2) {
+        std::string opcao = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Opção sem valor: " << opcao << std::endl;
+            std::exit(1);
+        }
+        std::string valor = argv[i + 1];
+        if (opcao == "--tamanhos") {
+            cfg.tamanhos.clear();
+            for (const auto& p : dividir(valor)) cfg.tamanhos.push_back(static_cast<size_t>(std::stod(p)));
+        } else if (opcao == "--threads") {
+            for (const auto& p : dividir(valor)) cfg.threads.push_back(std::stoi(p));
+        } else if (opcao == "--schedules") {
+            cfg.schedules = dividir(valor);
+        } else if (opcao == "--repeticoes") {
+            cfg.repeticoes = std::max(1, std::stoi(valor));
+        } else if (opcao == "--aquecimento") {
+            cfg.aquecimento = std::max(0, std::stoi(valor));
+        } else if (opcao == "--semente") {
+            cfg.semente = std::stoull(valor);
+        } else if (opcao == "--saida") {
+            cfg.saida = valor;
+        } else if (opcao == "--kernels") {
+            cfg.kernels = dividir(valor);
+        } else if (opcao == "--contadores") {
+            cfg.contadores = valor != "0";
+        } else if (opcao == "--afinidade") {
+            cfg.afinidade = valor == "compacta"    ? PoliticaAfinidade::COMPACTA
+                            : valor == "espalhada" ? PoliticaAfinidade::ESPALHADA
+                                                   : PoliticaAfinidade::NENHUMA;
+        } else {
+            std::cerr << "Opção desconhecida: " << opcao << std::endl;
+            std::exit(1);
+        }
+    }
+    if (cfg.threads.empty()) {
+        for (int t = 1; t < omp_get_max_threads(); t *= 2) cfg.threads.push_back(t);
+        cfg.threads.push_back(omp_get_max_threads());
+    }
+    // Em ordem crescente: a eficiência é relativa à primeira contagem medida, que deve ser a menor
+    std::sort(cfg.threads.begin(), cfg.threads.end());
+    cfg.threads.erase(std::unique(cfg.threads.begin(), cfg.threads.end()), cfg.threads.end());
+    return cfg;
+}
+
+// Aplica um schedule no formato "tipo[:chunk]" (ex.: "dynamic:1024") aos laços schedule(runtime)
+static void aplicar_schedule(const std::string& texto) {
+    size_t separador = texto.find(':');
+    std::string nome = texto.substr(0, separador);
+    int chunk = separador == std::string::npos ? 0 : std::stoi(texto.substr(separador + 1));
+
+    omp_sched_t tipo = omp_sched_static;
+    if (nome == "dynamic") tipo = omp_sched_dynamic;
+    else if (nome == "guided") tipo = omp_sched_guided;
+    else if (nome == "auto") tipo = omp_sched_auto;
+    omp_set_schedule(tipo, chunk);
+}
+
+static void gerar_dados(Dados& d, size_t n, uint64_t semente) {
+    d.salarios.resize(n);
+    preencher_normal(d.salarios.data(), n, semente, 5000.0, 1500.0);
+
+    d.inteiros.resize(n);
+    d.funcionarios.redimensionar(n);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        d.salarios[i] = std::max(1000.0, d.salarios[i]);
+        d.inteiros[i] = static_cast<int>(i + 1);
+        d.funcionarios.salario[i] = 2000.0 + (i % 100) * 50.0;
+        d.funcionarios.departamento[i] = static_cast<int>(i % 5) + 1;
+        d.funcionarios.idade[i] = 25 + static_cast<int>(i % 40);
+        d.funcionarios.horas_trabalhadas[i] = 160.0 + (i % 80);
+    }
+    d.centavos = para_centavos(d.salarios.data(), n);
+}
+
+// Visão de prefixo da tabela de funcionários (sem nomes, que as auditorias não leem)
+static TabelaFuncionarios prefixo(const TabelaFuncionarios& t, size_t n) {
+    TabelaFuncionarios p;
+    p.salario.assign(t.salario.begin(), t.salario.begin() + n);
+    p.departamento.assign(t.departamento.begin(), t.departamento.begin() + n);
+    p.idade.assign(t.idade.begin(), t.idade.begin() + n);
+    p.horas_trabalhadas.assign(t.horas_trabalhadas.begin(), t.horas_trabalhadas.begin() + n);
+    return p;
+}
+
+static std::vector<Kernel> criar_kernels(Dados& d, TabelaFuncionarios& tabela) {
+    const double* x = d.salarios.data();
+    const int* inteiros = d.inteiros.data();
+    const double D = sizeof(double);
+    const double I = sizeof(int);
+    const size_t SEM_LIMITE = std::numeric_limits<size_t>::max();
+    std::vector<Kernel> k;
+
+    // q1.cpp
+    k.push_back({"soma", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        double soma = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += x[i];
+        return soma;
+    }});
+    k.push_back({"soma_reprodutivel", "q1", D, false, SEM_LIMITE, [=](size_t n) {
+        return soma_reprodutivel(x, n);
+    }});
+    k.push_back({"produto", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        double produto = 1.0;
+        #pragma omp parallel for schedule(runtime) reduction(*:produto)
+        for (size_t i = 0; i < n; ++i) produto *= x[i] / 5000.0;
+        return produto;
+    }});
+    k.push_back({"maximo", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        double maximo = std::numeric_limits<double>::lowest();
+        #pragma omp parallel for schedule(runtime) reduction(max:maximo)
+        for (size_t i = 0; i < n; ++i) if (x[i] > maximo) maximo = x[i];
+        return maximo;
+    }});
+    k.push_back({"minimo", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        double minimo = std::numeric_limits<double>::max();
+        #pragma omp parallel for schedule(runtime) reduction(min:minimo)
+        for (size_t i = 0; i < n; ++i) if (x[i] < minimo) minimo = x[i];
+        return minimo;
+    }});
+    k.push_back({"and_logico", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        bool todos_positivos = true;
+        #pragma omp parallel for schedule(runtime) reduction(&&:todos_positivos)
+        for (size_t i = 0; i < n; ++i) todos_positivos = todos_positivos && (x[i] > 0);
+        return static_cast<double>(todos_positivos);
+    }});
+    k.push_back({"or_logico", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        bool existe_negativo = false;
+        #pragma omp parallel for schedule(runtime) reduction(||:existe_negativo)
+        for (size_t i = 0; i < n; ++i) existe_negativo = existe_negativo || (x[i] < 0);
+        return static_cast<double>(existe_negativo);
+    }});
+    // Mesma busca com saída antecipada (sem testemunha nos dados: mede o custo da varredura completa)
+    k.push_back({"primeiro_negativo", "q1", D, false, SEM_LIMITE, [=](size_t n) {
+        return static_cast<double>(encontrar_primeiro(x, n, [](double v) { return v < 0; }));
+    }});
+    k.push_back({"and_bits", "q1", I, true, SEM_LIMITE, [=](size_t n) {
+        int r = ~0;
+        #pragma omp parallel for schedule(runtime) reduction(&:r)
+        for (size_t i = 0; i < n; ++i) r &= inteiros[i];
+        return static_cast<double>(r);
+    }});
+    k.push_back({"or_bits", "q1", I, true, SEM_LIMITE, [=](size_t n) {
+        int r = 0;
+        #pragma omp parallel for schedule(runtime) reduction(|:r)
+        for (size_t i = 0; i < n; ++i) r |= inteiros[i];
+        return static_cast<double>(r);
+    }});
+    k.push_back({"xor_bits", "q1", I, true, SEM_LIMITE, [=](size_t n) {
+        int r = 0;
+        #pragma omp parallel for schedule(runtime) reduction(^:r)
+        for (size_t i = 0; i < n; ++i) r ^= inteiros[i];
+        return static_cast<double>(r);
+    }});
+    // Mesmas reduções pelos kernels despachados por CPUID (kernels_isa.hpp)
+    k.push_back({"maximo_isa", "q1", D, false, SEM_LIMITE, [=](size_t n) { return maximo_isa(x, n); }});
+    k.push_back({"minimo_isa", "q1", D, false, SEM_LIMITE, [=](size_t n) { return minimo_isa(x, n); }});
+    k.push_back({"and_bits_isa", "q1", I, false, SEM_LIMITE, [=](size_t n) {
+        return static_cast<double>(e_isa(inteiros, n));
+    }});
+    k.push_back({"or_bits_isa", "q1", I, false, SEM_LIMITE, [=](size_t n) {
+        return static_cast<double>(ou_isa(inteiros, n));
+    }});
+    k.push_back({"xor_bits_isa", "q1", I, false, SEM_LIMITE, [=](size_t n) {
+        return static_cast<double>(xou_isa(inteiros, n));
+    }});
+    k.push_back({"popcount_isa", "q1", I, false, SEM_LIMITE, [=](size_t n) {
+        return static_cast<double>(popcount_isa(inteiros, n));
+    }});
+    k.push_back({"soma_max_min", "q1", D, true, SEM_LIMITE, [=](size_t n) {
+        double soma = 0.0, maximo = std::numeric_limits<double>::lowest(), minimo = std::numeric_limits<double>::max();
+        #pragma omp parallel for schedule(runtime) reduction(+:soma) reduction(max:maximo) reduction(min:minimo)
+        for (size_t i = 0; i < n; ++i) {
+            soma += x[i];
+            if (x[i] > maximo) maximo = x[i];
+            if (x[i] < minimo) minimo = x[i];
+        }
+        return soma + maximo + minimo;
+    }});
+    k.push_back({"soma_critical", "q1", D, true, 1000000, [=](size_t n) {
+        double soma = 0.0;
+        #pragma omp parallel for schedule(runtime)
+        for (size_t i = 0; i < n; ++i) {
+            #pragma omp critical
+            soma += x[i];
+        }
+        return soma;
+    }});
+
+    // Escalonamento entre soquetes. d.salarios foi zerado por resize na thread principal,
+    // então todas as páginas estão num nó. A cópia em BufferNuma é refeita quando muda o
+    // número de threads (no aquecimento), para que o primeiro toque siga a divisão estática
+    // da equipe que vai ler.
+    k.push_back({"soma_toque_serial", "numa", D, false, SEM_LIMITE, [=](size_t n) {
+        double soma = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += x[i];
+        return soma;
+    }});
+    struct CopiaNuma {
+        BufferNuma<double> buffer;
+        int threads = 0;
+    };
+    auto copia = std::make_shared<CopiaNuma>();
+    k.push_back({"soma_toque_paralelo", "numa", D, false, SEM_LIMITE, [=](size_t n) {
+        if (copia->buffer.size() != n || copia->threads != omp_get_max_threads()) {
+            copia->buffer = BufferNuma<double>();
+            copia->buffer = BufferNuma<double>(n, [x](size_t i) { return x[i]; });
+            copia->threads = omp_get_max_threads();
+        }
+        const double* y = copia->buffer.data();
+        double soma = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += y[i];
+        return soma;
+    }});
+
+    // q2.cpp
+    k.push_back({"variancia_duas_passadas", "q2", 2 * D, true, SEM_LIMITE, [=](size_t n) {
+        double soma = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += x[i];
+        double media = soma / n;
+        double soma_quadrados = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma_quadrados)
+        for (size_t i = 0; i < n; ++i) soma_quadrados += (x[i] - media) * (x[i] - media);
+        return soma_quadrados / (n - 1);
+    }});
+    k.push_back({"variancia_uma_passada", "q2", D, true, SEM_LIMITE, [=](size_t n) {
+        double soma1 = 0.0, soma2 = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma1, soma2)
+        for (size_t i = 0; i < n; ++i) {
+            soma1 += x[i];
+            soma2 += x[i] * x[i];
+        }
+        return (soma2 - soma1 * soma1 / n) / (n - 1);
+    }});
+    k.push_back({"variancia_compensada", "q2", D, false, SEM_LIMITE, [=](size_t n) {
+        return acumular_compensado<MomentosCompensados>(x, n).variancia_amostral();
+    }});
+    k.push_back({"soma_neumaier", "q2", D, false, SEM_LIMITE, [=](size_t n) {
+        return acumular_compensado<SomaNeumaier>(x, n).valor();
+    }});
+    k.push_back({"soma_pairwise", "q2", D, false, SEM_LIMITE, [=](size_t n) {
+        return soma_pairwise(x, n);
+    }});
+    k.push_back({"welford", "q2", D, false, SEM_LIMITE, [=](size_t n) {
+        return welford_paralelo(x, n).M2;
+    }});
+    k.push_back({"welford_reprodutivel", "q2", D, false, SEM_LIMITE, [=](size_t n) {
+        return welford_reprodutivel(x, n).M2;
+    }});
+    const double C = d.centavos.estreita() ? sizeof(int32_t) : sizeof(int64_t);
+    k.push_back({"estatisticas_centavos", "q1", C, false, SEM_LIMITE, [&d](size_t n) {
+        const EstatisticasCentavos e = d.centavos.estreita() ? estatisticas_centavos(d.centavos.valores32.data(), n)
+                                                             : estatisticas_centavos(d.centavos.valores64.data(), n);
+        return static_cast<double>(e.soma);
+    }});
+
+    // q3.cpp. salario_aos percorre registros de 56 bytes (nome + campos, como a antiga struct
+    // Funcionario) para ler 8: com os contadores, os bytes da DRAM por elemento mostram as
+    // linhas de cache inteiras trazidas por salário, contra 8 bytes em salario_soa.
+    struct FuncionarioAoS {
+        std::string nome;
+        double salario;
+        int departamento;
+        int idade;
+        double horas_trabalhadas;
+    };
+    auto registros = std::make_shared<std::vector<FuncionarioAoS>>(tabela.salario.size());
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < registros->size(); ++i) {
+        (*registros)[i].salario = tabela.salario[i];
+        (*registros)[i].departamento = tabela.departamento[i];
+        (*registros)[i].idade = tabela.idade[i];
+        (*registros)[i].horas_trabalhadas = tabela.horas_trabalhadas[i];
+    }
+    k.push_back({"salario_aos", "q3", sizeof(FuncionarioAoS), true, SEM_LIMITE, [registros](size_t n) {
+        const FuncionarioAoS* r = registros->data();
+        double soma = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += r[i].salario;
+        return soma;
+    }});
+    k.push_back({"salario_soa", "q3", D, true, SEM_LIMITE, [&tabela](size_t n) {
+        const double* s = tabela.salario.data();
+        double soma = 0.0;
+        #pragma omp parallel for schedule(runtime) reduction(+:soma)
+        for (size_t i = 0; i < n; ++i) soma += s[i];
+        return soma;
+    }});
+    k.push_back({"auditoria", "q3", 2 * D + 2 * I, false, SEM_LIMITE, [&tabela](size_t) {
+        return static_cast<double>(auditar(tabela).violacoes_horas);
+    }});
+    k.push_back({"agrupamento_departamento", "q3", D + I, false, SEM_LIMITE, [&tabela](size_t n) {
+        return agrupar(tabela.departamento.data(), tabela.salario.data(), n, 6)[3].media();
+    }});
+
+    // q4.cpp
+    k.push_back({"resumo_salarial", "q4", D, false, SEM_LIMITE, [=](size_t n) {
+        static const std::vector<double> faixas = {0, 30000, 60000, 90000, 120000, 150000, 200000, 1e9};
+        return resumir_salarios(x, n, faixas).welford.M2;
+    }});
+    k.push_back({"percentis", "q4", D, false, SEM_LIMITE, [&d, x](size_t n) {
+        return d.seletor.selecionar(x, n, {0.25, 0.50, 0.75, 0.90})[1];
+    }});
+    k.push_back({"esboco_quantis", "q4", D, false, SEM_LIMITE, [=](size_t n) {
+        return esboco_paralelo(x, n).quantil(0.5);
+    }});
+    k.push_back({"ordenacao_std", "q4", D, false, SEM_LIMITE, [=](size_t n) {
+        std::vector<double> ordenados(x, x + n);
+        std::sort(ordenados.begin(), ordenados.end());
+        return ordenados[posicao_quantil(0.5, n)];
+    }});
+    k.push_back({"ordenacao_radix", "q4", D, false, SEM_LIMITE, [=](size_t n) {
+        return ColunaOrdenada(x, n).quantil(0.5);
+    }});
+
+    return k;
+}
+
+static double percentil(const std::vector<double>& ordenados, double p) {
+    size_t k = static_cast<size_t>(std::ceil(p * ordenados.size()));
+    return ordenados[std::min(ordenados.size() - 1, k > 0 ? k - 1 : 0)];
+}
+
+// Campos dos contadores de uma medição; null quando não medidos ou indisponíveis
+static void escrever_contadores(std::ostream& out, const Medicao& m, double banda_pico) {
+    const MedicaoContadores& c = m.contadores;
+    const bool hw = m.tem_contadores && c.hardware;
+    auto campo = [&out](const char* nome, bool valido, double valor) {
+        out << ", \"" << nome << "\": ";
+        if (valido) out << valor;
+        else out << "null";
+    };
+    campo("ciclos", hw, static_cast<double>(c.total.ciclos));
+    campo("instrucoes", hw, static_cast<double>(c.total.instrucoes));
+    campo("ipc", hw, c.total.ipc());
+    campo("falhas_llc", hw, static_cast<double>(c.total.falhas_llc));
+    campo("bytes_dram_por_elemento", hw, c.bytes_por_elemento(m.n));
+    campo("gb_por_s_dram", hw, c.banda_gbs());
+    campo("fracao_pico", hw && banda_pico > 0, c.banda_gbs() / banda_pico);
+    campo("tempo_cpu_s", m.tem_contadores && c.software, c.total.tempo_cpu_ns * 1e-9);
+}
+
+static void escrever_json(std::ostream& out, const Configuracao& cfg, const std::vector<Medicao>& medicoes,
+                          double banda_pico) {
+    out << "{\n";
+    out << "  \"semente\": " << cfg.semente << ",\n";
+    out << "  \"repeticoes\": " << cfg.repeticoes << ",\n";
+    out << "  \"aquecimento\": " << cfg.aquecimento << ",\n";
+    out << "  \"max_threads\": " << omp_get_max_threads() << ",\n";
+    out << "  \"kernels_isa\": \"" << kernels_isa().nome << "\",\n";
+    out << "  \"afinidade\": \"" << nome_politica(cfg.afinidade) << "\",\n";
+    out << "  \"nos_numa\": " << cpus_por_no().size() << ",\n";
+    if (cfg.contadores) {
+        out << "  \"contadores_hardware\": " << (hardware_disponivel() ? "true" : "false") << ",\n";
+        out << "  \"banda_pico_gb_por_s\": " << banda_pico << ",\n";
+    }
+    out << "  \"resultados\": [\n";
+    out.precision(9);
+    for (size_t i = 0; i < medicoes.size(); ++i) {
+        const Medicao& m = medicoes[i];
+        out << "    {\"kernel\": \"" << m.kernel << "\", \"origem\": \"" << m.origem << "\""
+            << ", \"schedule\": \"" << m.schedule << "\", \"n\": " << m.n << ", \"threads\": " << m.threads
+            << ", \"mediana_s\": " << m.mediana << ", \"p10_s\": " << m.p10 << ", \"p90_s\": " << m.p90
+            << ", \"minimo_s\": " << m.minimo << ", \"gb_por_s\": " << m.gbs
+            << ", \"eficiencia\": " << m.eficiencia;
+        if (cfg.contadores) escrever_contadores(out, m, banda_pico);
+        out << "}" << (i + 1 < medicoes.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    Configuracao cfg = ler_argumentos(argc, argv);
+    const size_t maior = *std::max_element(cfg.tamanhos.begin(), cfg.tamanhos.end());
+
+    Dados dados;
+    gerar_dados(dados, maior, cfg.semente);
+
+    double banda_pico = 0.0;
+    if (cfg.contadores) {
+        if (!hardware_disponivel()) {
+            std::cerr << "Contadores de hardware indisponíveis (" << motivo_indisponivel()
+                      << "); registrando só o tempo de CPU" << std::endl;
+        }
+        banda_pico = medir_banda_pico();
+        std::cerr << "Banda de leitura de pico: " << banda_pico << " GB/s" << std::endl;
+    }
+
+    std::vector<Medicao> medicoes;
+    for (size_t n : cfg.tamanhos) {
+        TabelaFuncionarios tabela = prefixo(dados.funcionarios, n);
+        std::vector<Kernel> kernels = criar_kernels(dados, tabela);
+
+        for (const Kernel& kernel : kernels) {
+            if (n > kernel.tamanho_maximo) continue;
+            if (!cfg.kernels.empty() &&
+                std::find(cfg.kernels.begin(), cfg.kernels.end(), kernel.nome) == cfg.kernels.end()) continue;
+            std::vector<std::string> schedules = kernel.usa_schedule ? cfg.schedules : std::vector<std::string>{"interno"};
+
+            for (const std::string& schedule : schedules) {
+                aplicar_schedule(schedule);
+                double tempo_base = 0.0;
+                int threads_base = 0;
+
+                for (int p : cfg.threads) {
+                    omp_set_num_threads(p);
+                    fixar_threads(cfg.afinidade, p);
+                    for (int a = 0; a < cfg.aquecimento; ++a) sumidouro = sumidouro + kernel.executar(n);
+
+                    std::vector<double> tempos;
+                    for (int r = 0; r < cfg.repeticoes; ++r) {
+                        double inicio = omp_get_wtime();
+                        sumidouro = sumidouro + kernel.executar(n);
+                        tempos.push_back(omp_get_wtime() - inicio);
+                    }
+                    std::sort(tempos.begin(), tempos.end());
+
+                    Medicao m;
+                    m.kernel = kernel.nome;
+                    m.origem = kernel.origem;
+                    m.schedule = schedule;
+                    m.n = n;
+                    m.threads = p;
+                    m.mediana = percentil(tempos, 0.5);
+                    m.p10 = percentil(tempos, 0.1);
+                    m.p90 = percentil(tempos, 0.9);
+                    m.minimo = tempos.front();
+                    m.gbs = kernel.bytes_por_elemento * n / m.mediana / 1e9;
+                    if (threads_base == 0) {
+                        tempo_base = m.mediana;
+                        threads_base = p;
+                    }
+                    m.eficiencia = (tempo_base * threads_base) / (m.mediana * p);
+                    if (cfg.contadores) {
+                        m.tem_contadores = true;
+                        m.contadores = medir_contadores([&] { sumidouro = sumidouro + kernel.executar(n); });
+                    }
+                    medicoes.push_back(m);
+
+                    std::cerr << kernel.origem << "/" << kernel.nome << " n=" << n << " " << schedule
+                              << " p=" << p << ": " << m.mediana * 1e3 << " ms";
+                    if (m.tem_contadores && m.contadores.hardware) {
+                        std::cerr << ", IPC " << m.contadores.total.ipc() << ", "
+                                  << m.contadores.bytes_por_elemento(n) << " B/elem da DRAM";
+                    }
+                    std::cerr << std::endl;
+                }
+            }
+        }
+    }
+    omp_set_num_threads(*std::max_element(cfg.threads.begin(), cfg.threads.end()));
+
+    if (cfg.saida.empty()) {
+        escrever_json(std::cout, cfg, medicoes, banda_pico);
+    } else {
+        std::ofstream arquivo(cfg.saida);
+        escrever_json(arquivo, cfg, medicoes, banda_pico);
+    }
+    return 0;
+}
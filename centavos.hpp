@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+// Modo de ponto fixo: salários guardados como centavos inteiros. Soma, mínimo, máximo e
+// soma de quadrados são exatos (aritmética inteira é associativa), então o resultado não
+// depende do número de threads nem do schedule.
+
+using int128 = __int128;
+
+// Coluna de salários em centavos. Usa int32 quando todos os valores cabem (metade da
+// largura de banda) e int64 caso contrário.
+struct ColunaCentavos {
+    std::vector<int32_t> valores32;
+    std::vector<int64_t> valores64;
+
+    bool estreita() const { return valores64.empty(); }
+    size_t tamanho() const { return estreita() ? valores32.size() : valores64.size(); }
+};
+
+// Converte reais (double) para centavos arredondando ao centavo mais próximo
+inline ColunaCentavos para_centavos(const double* reais, size_t n) {
+    double menor = 0.0, maior = 0.0;
+    #pragma omp parallel for simd reduction(min:menor) reduction(max:maior)
+    for (size_t i = 0; i < n; ++i) {
+        menor = std::min(menor, reais[i]);
+        maior = std::max(maior, reais[i]);
+    }
+
+    ColunaCentavos coluna;
+    const double LIMITE32 = static_cast<double>(std::numeric_limits<int32_t>::max()) / 100.0;
+    if (maior <= LIMITE32 && -menor <= LIMITE32) {
+        coluna.valores32.resize(n);
+        #pragma omp parallel for simd
+        for (size_t i = 0; i < n; ++i) {
+            coluna.valores32[i] = static_cast<int32_t>(std::llround(reais[i] * 100.0));
+        }
+    } else {
+        coluna.valores64.resize(n);
+        #pragma omp parallel for simd
+        for (size_t i = 0; i < n; ++i) {
+            coluna.valores64[i] = std::llround(reais[i] * 100.0);
+        }
+    }
+    return coluna;
+}
+
+struct EstatisticasCentavos {
+    long long contagem = 0;
+    int128 soma = 0;
+    int64_t minimo = std::numeric_limits<int64_t>::max();
+    int64_t maximo = std::numeric_limits<int64_t>::min();
+    int128 soma_quadrados = 0;
+
+    // Variância amostral em reais²: (n·Σx² − (Σx)²) / (n(n−1)) calculada sobre inteiros
+    // exatos; o único arredondamento é a conversão final para double.
+    double variancia_amostral_reais() const {
+        if (contagem < 2) return 0.0;
+        int128 numerador = static_cast<int128>(contagem) * soma_quadrados - soma * soma;
+        return static_cast<double>(numerador) / (static_cast<double>(contagem) * (contagem - 1)) / 10000.0;
+    }
+    double media_reais() const { return contagem ? static_cast<double>(soma) / contagem / 100.0 : 0.0; }
+};
+
+// Texto decimal exato de um int128 (iostream não imprime __int128)
+inline std::string int128_para_texto(int128 v) {
+    if (v == 0) return "0";
+    bool negativo = v < 0;
+    std::string texto;
+    while (v != 0) {
+        int digito = static_cast<int>(v % 10);
+        texto.push_back(static_cast<char>('0' + (negativo ? -digito : digito)));
+        v /= 10;
+    }
+    if (negativo) texto.push_back('-');
+    return std::string(texto.rbegin(), texto.rend());
+}
+
+// Centavos em reais com duas casas, sem passar por double
+inline std::string centavos_para_texto(int128 centavos) {
+    bool negativo = centavos < 0;
+    int128 absoluto = negativo ? -centavos : centavos;
+    std::string inteiro = int128_para_texto(absoluto / 100);
+    int resto = static_cast<int>(absoluto % 100);
+    return (negativo ? "-" : "") + inteiro + "," + (resto < 10 ? "0" : "") + std::to_string(resto);
+}
+
+// Somas parciais de um bloco de centavos int32 (ver estatisticas_centavos abaixo)
+struct BlocoCentavos {
+    int64_t soma, aa, ab, bb;
+    int32_t minimo, maximo;
+};
+
+// target_clones gera versões AVX-512, AVX2 e genérica do laço inteiro, escolhidas na carga
+__attribute__((target_clones("avx512f", "avx2", "default")))
+inline BlocoCentavos acumular_bloco_centavos(const int32_t* x, size_t n) {
+    int64_t s = 0, aa = 0, ab = 0, bb = 0;
+    int32_t mn = std::numeric_limits<int32_t>::max(), mx = std::numeric_limits<int32_t>::min();
+
+    #pragma omp simd reduction(+:s, aa, ab, bb) reduction(min:mn) reduction(max:mx)
+    for (size_t i = 0; i < n; ++i) {
+        // Produtos 32x32 -> 64 bits (pmuldq/pmuludq), sem multiplicação de 64 bits
+        const int32_t a = x[i] >> 16;       // deslocamento aritmético: parte alta com sinal
+        const int32_t b = x[i] & 0xFFFF;    // parte baixa sem sinal
+        s += x[i];
+        aa += static_cast<int64_t>(a) * a;
+        ab += static_cast<int64_t>(a) * b;
+        bb += static_cast<int64_t>(b) * b;
+        mn = x[i] < mn ? x[i] : mn;
+        mx = x[i] > mx ? x[i] : mx;
+    }
+    return {s, aa, ab, bb, mn, mx};
+}
+
+// Kernel int32: cada x é separado em x = a·2^16 + b (a com sinal, 0 <= b < 2^16), então
+// x² = a²·2^32 + 2ab·2^16 + b². Os três termos são somados em acumuladores de 64 bits
+// dentro de blocos (laço SIMD inteiro sem estouro) e levados a 128 bits ao fim de cada bloco.
+inline EstatisticasCentavos estatisticas_centavos(const int32_t* x, size_t n) {
+    // |a| <= 2^15, |ab| < 2^31, b² < 2^32: qualquer bloco de até 2^31 elementos cabe em int64
+    const size_t BLOCO = size_t(1) << 20;
+    const size_t numBlocos = (n + BLOCO - 1) / BLOCO;
+    EstatisticasCentavos total;
+    total.contagem = static_cast<long long>(n);
+
+    #pragma omp parallel
+    {
+        int128 soma = 0, soma_quadrados = 0;
+        int64_t menor = std::numeric_limits<int64_t>::max();
+        int64_t maior = std::numeric_limits<int64_t>::min();
+
+        #pragma omp for schedule(static) nowait
+        for (size_t bloco = 0; bloco < numBlocos; ++bloco) {
+            const size_t inicio = bloco * BLOCO;
+            BlocoCentavos p = acumular_bloco_centavos(x + inicio, std::min(n - inicio, BLOCO));
+
+            soma += p.soma;
+            soma_quadrados += (static_cast<int128>(p.aa) << 32) + (static_cast<int128>(p.ab) << 17) + p.bb;
+            menor = std::min<int64_t>(menor, p.minimo);
+            maior = std::max<int64_t>(maior, p.maximo);
+        }
+
+        #pragma omp critical
+        {
+            total.soma += soma;
+            total.soma_quadrados += soma_quadrados;
+            total.minimo = std::min(total.minimo, menor);
+            total.maximo = std::max(total.maximo, maior);
+        }
+    }
+    return total;
+}
+
+// Somas parciais de um bloco de centavos int64 (ver o kernel int64 abaixo)
+struct BlocoCentavos64 {
+    int64_t soma_alta, soma_baixa, aa, am, ab, mm, mb, bb;
+    int64_t minimo, maximo;
+};
+
+__attribute__((target_clones("avx512f", "avx2", "default")))
+inline BlocoCentavos64 acumular_bloco_centavos(const int64_t* x, size_t n) {
+    int64_t sa = 0, sb = 0, aa = 0, am = 0, ab = 0, mm = 0, mb = 0, bb = 0;
+    int64_t mn = std::numeric_limits<int64_t>::max(), mx = std::numeric_limits<int64_t>::min();
+    const int64_t MASCARA21 = (int64_t(1) << 21) - 1;
+
+    #pragma omp simd reduction(+:sa, sb, aa, am, ab, mm, mb, bb) reduction(min:mn) reduction(max:mx)
+    for (size_t i = 0; i < n; ++i) {
+        // Partes de 21 bits em int32, para os produtos 32x32 -> 64 bits (pmuldq)
+        const int32_t a = static_cast<int32_t>(x[i] >> 42);
+        const int32_t m = static_cast<int32_t>((x[i] >> 21) & MASCARA21);
+        const int32_t b = static_cast<int32_t>(x[i] & MASCARA21);
+        sa += a;
+        sb += x[i] & ((int64_t(1) << 42) - 1);
+        aa += static_cast<int64_t>(a) * a;
+        am += static_cast<int64_t>(a) * m;
+        ab += static_cast<int64_t>(a) * b;
+        mm += static_cast<int64_t>(m) * m;
+        mb += static_cast<int64_t>(m) * b;
+        bb += static_cast<int64_t>(b) * b;
+        mn = x[i] < mn ? x[i] : mn;
+        mx = x[i] > mx ? x[i] : mx;
+    }
+    return {sa, sb, aa, am, ab, mm, mb, bb, mn, mx};
+}
+
+// Kernel int64: o mesmo esquema do int32 com três partes, x = a·2^42 + m·2^21 + b (a com
+// sinal, 0 <= m, b < 2^21), então x² = a²·2^84 + 2am·2^63 + (m² + 2ab)·2^42 + 2mb·2^21 + b².
+// A soma também é dividida (a e os 42 bits baixos) para não estourar dentro do bloco.
+inline EstatisticasCentavos estatisticas_centavos(const int64_t* x, size_t n) {
+    // |a| <= 2^21 e m, b < 2^21: cada produto tem menos de 2^42, e um bloco de 2^20 cabe em int64
+    const size_t BLOCO = size_t(1) << 20;
+    const size_t numBlocos = (n + BLOCO - 1) / BLOCO;
+    EstatisticasCentavos total;
+    total.contagem = static_cast<long long>(n);
+
+    #pragma omp parallel
+    {
+        int128 soma = 0, soma_quadrados = 0;
+        int64_t menor = std::numeric_limits<int64_t>::max();
+        int64_t maior = std::numeric_limits<int64_t>::min();
+
+        #pragma omp for schedule(static) nowait
+        for (size_t bloco = 0; bloco < numBlocos; ++bloco) {
+            const size_t inicio = bloco * BLOCO;
+            BlocoCentavos64 p = acumular_bloco_centavos(x + inicio, std::min(n - inicio, BLOCO));
+
+            soma += (static_cast<int128>(p.soma_alta) << 42) + p.soma_baixa;
+            soma_quadrados += (static_cast<int128>(p.aa) << 84) + (static_cast<int128>(p.am) << 64) +
+                              (static_cast<int128>(p.mm + 2 * p.ab) << 42) + (static_cast<int128>(p.mb) << 22) + p.bb;
+            menor = std::min(menor, p.minimo);
+            maior = std::max(maior, p.maximo);
+        }
+
+        #pragma omp critical
+        {
+            total.soma += soma;
+            total.soma_quadrados += soma_quadrados;
+            total.minimo = std::min(total.minimo, menor);
+            total.maximo = std::max(total.maximo, maior);
+        }
+    }
+    return total;
+}
+
+inline EstatisticasCentavos estatisticas_centavos(const ColunaCentavos& coluna) {
+    return coluna.estreita() ? estatisticas_centavos(coluna.valores32.data(), coluna.valores32.size())
+                             : estatisticas_centavos(coluna.valores64.data(), coluna.valores64.size());
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <omp.h>
+
+// Acumuladores com soma compensada, registrados como reductions OpenMP.
+//
+//   SomaKahan              Kahan clássico
+//   SomaNeumaier           Kahan-Babuška-Neumaier (robusto quando a parcela é maior que a soma)
+//   MomentosCompensados    Σx e Σx² compensados (o erro de x² vem exato de um fma), o que
+//                          torna a variância de uma passada, (Σx² − (Σx)²/n)/n, tão precisa
+//                          quanto a de duas passadas
+//   soma_pairwise          soma par a par recursiva
+//
+// Cada acumulador tem adicionar() (um elemento), adicionar_bloco() (laço em SOMA_COMP_LANES
+// lanes independentes, que vetoriza) e combinar() (usado pelas reductions).
+const int SOMA_COMP_LANES = 8;
+
+// Soma exata de dois doubles: a + b = s + erro
+inline void two_sum(double a, double b, double& s, double& erro) {
+    s = a + b;
+    double bb = s - a;
+    erro = (a - (s - bb)) + (b - bb);
+}
+
+struct SomaKahan {
+    double soma = 0.0;
+    double c = 0.0;  // compensação (erro acumulado com sinal trocado)
+
+    void adicionar(double x) {
+        double y = x - c;
+        double t = soma + y;
+        c = (t - soma) - y;
+        soma = t;
+    }
+
+    __attribute__((target_clones("avx512f", "avx2", "default")))
+    void adicionar_bloco(const double* x, size_t n) {
+        double s[SOMA_COMP_LANES] = {}, comp[SOMA_COMP_LANES] = {};
+        const size_t completos = n / SOMA_COMP_LANES * SOMA_COMP_LANES;
+        for (size_t i = 0; i < completos; i += SOMA_COMP_LANES) {
+            #pragma omp simd
+            for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+                double y = x[i + l] - comp[l];
+                double t = s[l] + y;
+                comp[l] = (t - s[l]) - y;
+                s[l] = t;
+            }
+        }
+        for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+            SomaKahan lane;
+            lane.soma = s[l];
+            lane.c = comp[l];
+            combinar(lane);
+        }
+        for (size_t i = completos; i < n; ++i) adicionar(x[i]);
+    }
+
+    void combinar(const SomaKahan& outra) {
+        adicionar(outra.soma);
+        adicionar(-outra.c);
+    }
+
+    double valor() const { return soma - c; }
+};
+
+struct SomaNeumaier {
+    double soma = 0.0;
+    double c = 0.0;  // erro acumulado (somado no final)
+
+    void adicionar(double x) {
+        double t = soma + x;
+        c += (std::fabs(soma) >= std::fabs(x)) ? (soma - t) + x : (x - t) + soma;
+        soma = t;
+    }
+
+    // no-trapping-math: sem ele, o clone AVX2 não troca a escolha de ramo por um blend
+    __attribute__((target_clones("avx512f", "avx2", "default"), optimize("no-trapping-math")))
+    void adicionar_bloco(const double* x, size_t n) {
+        double s[SOMA_COMP_LANES] = {}, comp[SOMA_COMP_LANES] = {};
+        const size_t completos = n / SOMA_COMP_LANES * SOMA_COMP_LANES;
+        for (size_t i = 0; i < completos; i += SOMA_COMP_LANES) {
+            #pragma omp simd
+            for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+                double v = x[i + l];
+                double t = s[l] + v;
+                comp[l] += (std::fabs(s[l]) >= std::fabs(v)) ? (s[l] - t) + v : (v - t) + s[l];
+                s[l] = t;
+            }
+        }
+        for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+            adicionar(s[l]);
+            c += comp[l];
+        }
+        for (size_t i = completos; i < n; ++i) adicionar(x[i]);
+    }
+
+    void combinar(const SomaNeumaier& outra) {
+        adicionar(outra.soma);
+        c += outra.c;
+    }
+
+    double valor() const { return soma + c; }
+};
+
+struct MomentosCompensados {
+    long long contagem = 0;
+    SomaNeumaier s1;  // Σx
+    SomaNeumaier s2;  // Σx², cada x² somado junto com seu erro de arredondamento
+
+    void adicionar(double x) {
+        double p = x * x;
+        s1.adicionar(x);
+        s2.adicionar(p);
+        s2.c += std::fma(x, x, -p);
+        ++contagem;
+    }
+
+    // O clone AVX2 é "arch=haswell" para ter FMA: com "avx2" só, std::fma vira uma chamada à
+    // libm por elemento e o laço deixa de vetorizar. fp-contract=off impede que v·v seja fundido
+    // na soma seguinte (q + v·v num fma), o que descasaria a compensação do produto usado.
+    // no-trapping-math deixa o GCC trocar as escolhas de ramo por blends sem máscaras AVX-512
+    // (não muda nenhum resultado). O clone genérico (CPUs sem AVX2) continua chamando fma da libm.
+    __attribute__((target_clones("avx512f", "arch=haswell", "default"),
+                   optimize("fp-contract=off", "no-trapping-math")))
+    void adicionar_bloco(const double* x, size_t n) {
+        double a[SOMA_COMP_LANES] = {}, ca[SOMA_COMP_LANES] = {};
+        double q[SOMA_COMP_LANES] = {}, cq[SOMA_COMP_LANES] = {};
+        const size_t completos = n / SOMA_COMP_LANES * SOMA_COMP_LANES;
+        for (size_t i = 0; i < completos; i += SOMA_COMP_LANES) {
+            #pragma omp simd
+            for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+                double v = x[i + l];
+                double t = a[l] + v;
+                ca[l] += (std::fabs(a[l]) >= std::fabs(v)) ? (a[l] - t) + v : (v - t) + a[l];
+                a[l] = t;
+
+                double p = v * v;
+                double u = q[l] + p;
+                cq[l] += ((q[l] >= p) ? (q[l] - u) + p : (p - u) + q[l]) + std::fma(v, v, -p);
+                q[l] = u;
+            }
+        }
+        for (int l = 0; l < SOMA_COMP_LANES; ++l) {
+            s1.adicionar(a[l]);
+            s1.c += ca[l];
+            s2.adicionar(q[l]);
+            s2.c += cq[l];
+        }
+        contagem += static_cast<long long>(completos);
+        for (size_t i = completos; i < n; ++i) adicionar(x[i]);
+    }
+
+    void combinar(const MomentosCompensados& outro) {
+        contagem += outro.contagem;
+        s1.combinar(outro.s1);
+        s2.combinar(outro.s2);
+    }
+
+    double media() const { return contagem ? s1.valor() / contagem : 0.0; }
+
+    // n·variância populacional = Σx² − (Σx)²/n, avaliado em double-double: (Σx)² sai
+    // exato de fma e a subtração dos termos altos, que são quase iguais, é exata.
+    double soma_desvios_quadrados() const {
+        if (contagem < 2) return 0.0;
+        const double n = static_cast<double>(contagem);
+
+        double a_hi, a_lo;
+        two_sum(s1.soma, s1.c, a_hi, a_lo);
+        double q_hi, q_lo;
+        two_sum(s2.soma, s2.c, q_hi, q_lo);
+
+        // (Σx)² = a_hi² + 2·a_hi·a_lo (+ a_lo², desprezível)
+        double p = a_hi * a_hi;
+        double p_erro = std::fma(a_hi, a_hi, -p) + 2.0 * a_hi * a_lo;
+        double quociente = p / n;
+        double resto = (std::fma(-quociente, n, p) + p_erro) / n;
+
+        double resultado = (q_hi - quociente) + (q_lo - resto);
+        return resultado > 0.0 ? resultado : 0.0;
+    }
+
+    double variancia_populacional() const { return contagem ? soma_desvios_quadrados() / contagem : 0.0; }
+    double variancia_amostral() const { return contagem > 1 ? soma_desvios_quadrados() / (contagem - 1) : 0.0; }
+};
+
+#pragma omp declare reduction(soma_kahan : SomaKahan : omp_out.combinar(omp_in)) \
+    initializer(omp_priv = SomaKahan())
+#pragma omp declare reduction(soma_neumaier : SomaNeumaier : omp_out.combinar(omp_in)) \
+    initializer(omp_priv = SomaNeumaier())
+#pragma omp declare reduction(momentos_compensados : MomentosCompensados : omp_out.combinar(omp_in)) \
+    initializer(omp_priv = MomentosCompensados())
+
+// Laços paralelos prontos: blocos de BLOCO_COMPENSADO elementos por iteração, acumulados
+// com adicionar_bloco e combinados pelas reductions acima
+const size_t BLOCO_COMPENSADO = 2048;
+
+template <typename Acumulador>
+Acumulador acumular_compensado(const double* x, size_t n);
+
+template <>
+inline SomaKahan acumular_compensado<SomaKahan>(const double* x, size_t n) {
+    SomaKahan acc;
+    #pragma omp parallel for schedule(static) reduction(soma_kahan:acc)
+    for (size_t i = 0; i < n; i += BLOCO_COMPENSADO) {
+        acc.adicionar_bloco(x + i, (n - i < BLOCO_COMPENSADO) ? n - i : BLOCO_COMPENSADO);
+    }
+    return acc;
+}
+
+template <>
+inline SomaNeumaier acumular_compensado<SomaNeumaier>(const double* x, size_t n) {
+    SomaNeumaier acc;
+    #pragma omp parallel for schedule(static) reduction(soma_neumaier:acc)
+    for (size_t i = 0; i < n; i += BLOCO_COMPENSADO) {
+        acc.adicionar_bloco(x + i, (n - i < BLOCO_COMPENSADO) ? n - i : BLOCO_COMPENSADO);
+    }
+    return acc;
+}
+
+template <>
+inline MomentosCompensados acumular_compensado<MomentosCompensados>(const double* x, size_t n) {
+    MomentosCompensados acc;
+    #pragma omp parallel for schedule(static) reduction(momentos_compensados:acc)
+    for (size_t i = 0; i < n; i += BLOCO_COMPENSADO) {
+        acc.adicionar_bloco(x + i, (n - i < BLOCO_COMPENSADO) ? n - i : BLOCO_COMPENSADO);
+    }
+    return acc;
+}
+
+// Soma par a par: erro O(log n · ε) em vez de O(n · ε). A base é um laço de 8 lanes.
+inline double soma_pairwise_serial(const double* x, size_t n) {
+    if (n <= 256) {
+        double lanes[8] = {};
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            #pragma omp simd
+            for (int l = 0; l < 8; ++l) lanes[l] += x[i + l];
+        }
+        double s = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        for (; i < n; ++i) s += x[i];
+        return s;
+    }
+    size_t metade = n / 2;
+    return soma_pairwise_serial(x, metade) + soma_pairwise_serial(x + metade, n - metade);
+}
+
+// Versão paralela: a árvore é dividida em uma folha por thread e as folhas são somadas par a par
+inline double soma_pairwise(const double* x, size_t n) {
+    const int maxThreads = omp_get_max_threads();
+    std::vector<double> folhas(maxThreads, 0.0);
+    int usadas = 1;
+
+    #pragma omp parallel num_threads(maxThreads)
+    {
+        const int t = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const size_t ini = n * t / nt;
+        const size_t fim = n * (t + 1) / nt;
+        folhas[t] = soma_pairwise_serial(x + ini, fim - ini);
+        #pragma omp single
+        usadas = nt;
+    }
+
+    for (int passo = 1; passo < usadas; passo *= 2) {
+        for (int t = 0; t + passo < usadas; t += 2 * passo) folhas[t] += folhas[t + passo];
+    }
+    return folhas[0];
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#include "numa.hpp"
+
+// Contadores de desempenho por thread via perf_event_open.
+//
+// medir_contadores(f) abre (uma vez por thread, em thread_local) um grupo de contadores em
+// cada thread da equipe OpenMP, zera e liga todos, executa f() e lê os valores de volta. O
+// runtime reaproveita as mesmas threads nas regiões seguintes com o mesmo número de threads,
+// então as regiões abertas dentro de f() são contadas.
+//
+// Eventos: ciclos, instruções, referências e falhas da LLC (PERF_COUNT_HW_CACHE_*) e o
+// tempo de CPU da thread (task-clock, por software). Falhas da LLC × 64 bytes é a aproximação
+// de tráfego com a DRAM. Máquinas virtuais sem PMU, contêineres sem permissão ou
+// perf_event_paranoid alto deixam só o task-clock (ou nada): hardware_disponivel() diz qual
+// caso, e motivo_indisponivel() traz o errno.
+
+const size_t BYTES_LINHA_CACHE = 64;
+
+struct LeituraContadores {
+    uint64_t ciclos = 0;
+    uint64_t instrucoes = 0;
+    uint64_t referencias_llc = 0;
+    uint64_t falhas_llc = 0;
+    uint64_t tempo_cpu_ns = 0;  // task-clock
+
+    void somar(const LeituraContadores& o) {
+        ciclos += o.ciclos;
+        instrucoes += o.instrucoes;
+        referencias_llc += o.referencias_llc;
+        falhas_llc += o.falhas_llc;
+        tempo_cpu_ns += o.tempo_cpu_ns;
+    }
+
+    double ipc() const { return ciclos ? static_cast<double>(instrucoes) / ciclos : 0.0; }
+    double bytes_dram() const { return static_cast<double>(falhas_llc) * BYTES_LINHA_CACHE; }
+};
+
+struct MedicaoContadores {
+    bool hardware = false;                   // ciclos/instruções/LLC válidos
+    bool software = false;                   // task-clock válido
+    double tempo_s = 0.0;                    // relógio de parede de f()
+    LeituraContadores total;
+    std::vector<LeituraContadores> por_thread;
+
+    // Métricas para n elementos
+    double bytes_por_elemento(size_t n) const { return n ? total.bytes_dram() / n : 0.0; }
+    double banda_gbs() const { return tempo_s > 0 ? total.bytes_dram() / tempo_s / 1e9 : 0.0; }
+    double ciclos_por_elemento(size_t n) const { return n ? static_cast<double>(total.ciclos) / n : 0.0; }
+};
+
+namespace detalhe_contadores {
+
+enum Indice { CICLOS, INSTRUCOES, REFERENCIAS_LLC, FALHAS_LLC, NUM_HARDWARE };
+
+inline int abrir(uint32_t tipo, uint64_t config, int lider) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = tipo;
+    attr.config = config;
+    attr.disabled = lider == -1 ? 1 : 0;  // o grupo é ligado pelo líder
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, lider, 0));
+}
+
+// Lê um contador escalado pela fração do tempo em que esteve no PMU (multiplexação)
+inline uint64_t ler(int fd) {
+    if (fd < 0) return 0;
+    uint64_t valores[3] = {0, 0, 0};  // valor, tempo ligado, tempo rodando
+    if (read(fd, valores, sizeof(valores)) != static_cast<ssize_t>(sizeof(valores))) return 0;
+    if (valores[2] == 0) return 0;
+    return valores[2] < valores[1]
+               ? static_cast<uint64_t>(static_cast<double>(valores[0]) * valores[1] / valores[2])
+               : valores[0];
+}
+
+struct ContadoresThread {
+    int hardware[NUM_HARDWARE] = {-1, -1, -1, -1};
+    int relogio = -1;
+    int erro_hardware = 0;
+
+    ContadoresThread() {
+        hardware[CICLOS] = abrir(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (hardware[CICLOS] < 0) {
+            erro_hardware = errno;
+        } else {
+            hardware[INSTRUCOES] = abrir(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, hardware[CICLOS]);
+            hardware[REFERENCIAS_LLC] = abrir(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, hardware[CICLOS]);
+            hardware[FALHAS_LLC] = abrir(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, hardware[CICLOS]);
+        }
+        relogio = abrir(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1);
+    }
+
+    ~ContadoresThread() {
+        for (int fd : hardware) {
+            if (fd >= 0) close(fd);
+        }
+        if (relogio >= 0) close(relogio);
+    }
+
+    void ligar() {
+        for (int fd : {hardware[CICLOS], relogio}) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    LeituraContadores desligar_e_ler() {
+        for (int fd : {hardware[CICLOS], relogio}) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+        LeituraContadores l;
+        l.ciclos = ler(hardware[CICLOS]);
+        l.instrucoes = ler(hardware[INSTRUCOES]);
+        l.referencias_llc = ler(hardware[REFERENCIAS_LLC]);
+        l.falhas_llc = ler(hardware[FALHAS_LLC]);
+        l.tempo_cpu_ns = ler(relogio);
+        return l;
+    }
+};
+
+inline ContadoresThread& desta_thread() {
+    thread_local ContadoresThread contadores;
+    return contadores;
+}
+
+} // namespace detalhe_contadores
+
+inline bool hardware_disponivel() { return detalhe_contadores::desta_thread().hardware[detalhe_contadores::CICLOS] >= 0; }
+inline bool software_disponivel() { return detalhe_contadores::desta_thread().relogio >= 0; }
+
+inline std::string motivo_indisponivel() {
+    int erro = detalhe_contadores::desta_thread().erro_hardware;
+    return erro ? std::string(std::strerror(erro)) : std::string();
+}
+
+// Executa f() com os contadores ligados em cada thread da equipe atual
+template <typename Funcao>
+MedicaoContadores medir_contadores(Funcao f) {
+    const int threads = omp_get_max_threads();
+    MedicaoContadores m;
+    m.hardware = hardware_disponivel();
+    m.software = software_disponivel();
+    m.por_thread.resize(threads);
+
+    #pragma omp parallel num_threads(threads)
+    detalhe_contadores::desta_thread().ligar();
+
+    double inicio = omp_get_wtime();
+    f();
+    m.tempo_s = omp_get_wtime() - inicio;
+
+    #pragma omp parallel num_threads(threads)
+    m.por_thread[omp_get_thread_num()] = detalhe_contadores::desta_thread().desligar_e_ler();
+
+    for (const LeituraContadores& l : m.por_thread) m.total.somar(l);
+    return m;
+}
+
+// Banda de leitura de pico (soma paralela de um vetor bem maior que a LLC), em GB/s: a
+// referência de "banda atingida / pico" nos relatórios
+inline double medir_banda_pico(size_t bytes = size_t(256) << 20) {
+    const size_t n = bytes / sizeof(double);
+    BufferNuma<double> buffer(n, [](size_t) { return 1.0; });
+    const double* b = buffer.data();
+
+    double melhor = 0.0;
+    volatile double sumidouro = 0.0;
+    for (int r = 0; r < 5; ++r) {
+        double inicio = omp_get_wtime();
+        double s = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:s)
+        for (size_t i = 0; i < n; ++i) s += b[i];
+        double tempo = omp_get_wtime() - inicio;
+        sumidouro = s;
+        melhor = std::max(melhor, bytes / tempo / 1e9);
+    }
+    (void)sumidouro;
+    return melhor;
+}
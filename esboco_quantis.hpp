@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "quantis.hpp"
+
+// Esboço de quantis KLL (Karnin, Lang e Liberty): quantis aproximados com memória limitada,
+// combinável entre threads, blocos de um fluxo ou grupos.
+//
+// Os valores ficam numa pilha de compactadores; um item no nível h representa 2^h valores.
+// Quando o esboço enche, o nível mais baixo que passou da capacidade é ordenado e metade dos
+// itens (os de posição par ou os de posição ímpar) sobe para o nível seguinte com peso dobrado.
+// A capacidade do nível h é k·(2/3)^(altura − 1 − h), com mínimo de 8 itens, então os níveis
+// baixos são pequenos e a memória total fica em O(k). O peso total é preservado: quantil() devolve o valor cujo rank
+// acumulado alcança o rank pedido, com erro de rank normalizado da ordem de erro_rank_estimado()
+// (≈1,3% com k = 200). Mínimo e máximo são exatos.
+//
+// A escolha par/ímpar vem de um gerador splitmix64 com semente fixa, então o mesmo fluxo de
+// entrada (na mesma ordem de combinação) dá sempre o mesmo esboço.
+//
+// k = 0 cria um esboço inativo: adicionar() não faz nada. É o padrão em ResumoSalarial e
+// EstatisticaGrupo, que só pagam o custo do esboço quando ele é pedido.
+class EsbocoQuantis {
+public:
+    static constexpr int K_PADRAO = 200;
+
+    explicit EsbocoQuantis(int k = 0) : k_(k) {}
+
+    bool ativo() const { return k_ > 0; }
+    int k() const { return k_; }
+    long long contagem() const { return contagem_; }
+    double minimo() const { return minimo_; }
+    double maximo() const { return maximo_; }
+
+    // Erro de rank normalizado típico (fórmula empírica das implementações de referência do KLL)
+    double erro_rank_estimado() const { return ativo() ? 2.296 / std::pow(k_, 0.9723) : 0.0; }
+
+    void adicionar(double x) {
+        if (!ativo()) return;
+        if (niveis_.empty()) crescer();
+        niveis_[0].push_back(x);
+        ++contagem_;
+        if (x < minimo_) minimo_ = x;
+        if (x > maximo_) maximo_ = x;
+        if (++itens_ >= capacidade_total_) compactar();
+    }
+
+    void adicionar_bloco(const double* x, size_t n) {
+        for (size_t i = 0; i < n; ++i) adicionar(x[i]);
+    }
+
+    void combinar(const EsbocoQuantis& o) {
+        if (o.contagem_ == 0) return;
+        if (!ativo()) {
+            *this = o;
+            return;
+        }
+        while (niveis_.size() < o.niveis_.size()) crescer();
+        for (size_t h = 0; h < o.niveis_.size(); ++h) {
+            niveis_[h].insert(niveis_[h].end(), o.niveis_[h].begin(), o.niveis_[h].end());
+        }
+        contagem_ += o.contagem_;
+        itens_ += o.itens_;
+        minimo_ = std::min(minimo_, o.minimo_);
+        maximo_ = std::max(maximo_, o.maximo_);
+        estado_ ^= o.estado_;
+        while (itens_ >= capacidade_total_) compactar();
+    }
+
+    // Mesma convenção de posição do motor exato (posicao_quantil): o valor de rank
+    // floor(q·n) + 1 entre os n valores ordenados
+    double quantil(double q) const { return quantis({q})[0]; }
+
+    std::vector<double> quantis(const std::vector<double>& qs) const {
+        std::vector<double> resultado(qs.size(), std::numeric_limits<double>::quiet_NaN());
+        if (contagem_ == 0) return resultado;
+
+        std::vector<std::pair<double, uint64_t>> pesados;
+        pesados.reserve(itens_);
+        for (size_t h = 0; h < niveis_.size(); ++h) {
+            for (double v : niveis_[h]) pesados.emplace_back(v, uint64_t(1) << h);
+        }
+        std::sort(pesados.begin(), pesados.end());
+
+        for (size_t j = 0; j < qs.size(); ++j) {
+            if (qs[j] <= 0.0) {
+                resultado[j] = minimo_;
+                continue;
+            }
+            if (qs[j] >= 1.0) {
+                resultado[j] = maximo_;
+                continue;
+            }
+            const uint64_t alvo = posicao_quantil(qs[j], static_cast<size_t>(contagem_)) + 1;
+            uint64_t acumulado = 0;
+            resultado[j] = maximo_;
+            for (const auto& p : pesados) {
+                acumulado += p.second;
+                if (acumulado >= alvo) {
+                    resultado[j] = p.first;
+                    break;
+                }
+            }
+        }
+        return resultado;
+    }
+
+    // Itens guardados (memória do esboço, sem contar os vetores)
+    size_t itens() const { return itens_; }
+
+private:
+    int k_;
+    std::vector<std::vector<double>> niveis_;
+    long long contagem_ = 0;
+    size_t itens_ = 0;
+    std::vector<size_t> capacidades_;  // por nível, recalculadas quando a altura muda
+    size_t capacidade_total_ = 0;
+    double minimo_ = std::numeric_limits<double>::max();
+    double maximo_ = std::numeric_limits<double>::lowest();
+    uint64_t estado_ = 0x853C49E6748FEA9BULL;
+
+    static constexpr size_t CAPACIDADE_MINIMA = 8;
+
+    void crescer() {
+        niveis_.emplace_back();
+        const size_t altura = niveis_.size();
+        capacidades_.resize(altura);
+        capacidade_total_ = 0;
+        for (size_t h = 0; h < altura; ++h) {
+            const double c = k_ * std::pow(2.0 / 3.0, static_cast<double>(altura - 1 - h));
+            capacidades_[h] = std::max(CAPACIDADE_MINIMA, static_cast<size_t>(std::ceil(c)));
+            capacidade_total_ += capacidades_[h];
+        }
+    }
+
+    bool moeda() {
+        uint64_t z = (estado_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return ((z ^ (z >> 31)) & 1) != 0;
+    }
+
+    // Compacta o nível mais baixo acima da capacidade: metade dos itens sobe um nível
+    void compactar() {
+        for (size_t h = 0; h < niveis_.size(); ++h) {
+            if (niveis_[h].size() < capacidades_[h]) continue;
+            if (h + 1 == niveis_.size()) crescer();
+            std::vector<double>& atual = niveis_[h];
+            std::vector<double>& acima = niveis_[h + 1];
+
+            // Com número ímpar de itens, o último (maior) fica no nível para o peso bater
+            std::sort(atual.begin(), atual.end());
+            double sobra = 0.0;
+            const bool impar = atual.size() % 2 == 1;
+            if (impar) {
+                sobra = atual.back();
+                atual.pop_back();
+            }
+            const size_t inicio = moeda() ? 1 : 0;
+            for (size_t i = inicio; i < atual.size(); i += 2) acima.push_back(atual[i]);
+            itens_ -= atual.size() / 2;
+            atual.clear();
+            if (impar) atual.push_back(sobra);
+            return;
+        }
+    }
+};
+
+#pragma omp declare reduction(esboco_quantis : EsbocoQuantis : omp_out.combinar(omp_in)) \
+    initializer(omp_priv = EsbocoQuantis(omp_orig.k()))
+
+// Esboço de x[0..n) em paralelo: um esboço por thread, combinados pela redução
+inline EsbocoQuantis esboco_paralelo(const double* x, size_t n, int k = EsbocoQuantis::K_PADRAO) {
+    EsbocoQuantis esboco(k);
+    #pragma omp parallel for schedule(static) reduction(esboco_quantis:esboco)
+    for (size_t i = 0; i < n; ++i) esboco.adicionar(x[i]);
+    return esboco;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <omp.h>
+#include "welford.hpp"
+#include "esboco_quantis.hpp"
+
+// Resumo de uma passada sobre os salários: soma, Welford (média/M2), mínimo, máximo,
+// histograma por faixas e, com kEsboco > 0, um esboço KLL para os percentis. É combinável,
+// então pode ser acumulado por thread ou por bloco.
+struct ResumoSalarial {
+    double soma;
+    WelfordAccumulator welford;
+    double minimo;
+    double maximo;
+    std::vector<long long> faixas;
+    EsbocoQuantis esboco;
+
+    explicit ResumoSalarial(size_t numFaixas = 0, int kEsboco = 0)
+        : soma(0.0),
+          minimo(std::numeric_limits<double>::max()),
+          maximo(std::numeric_limits<double>::lowest()),
+          faixas(numFaixas, 0),
+          esboco(kEsboco) {}
+
+    long long contagem() const { return welford.count; }
+    double media() const { return welford.count > 0 ? welford.mean : 0.0; }
+    double variancia_amostral() const {
+        return welford.count > 1 ? welford.M2 / (welford.count - 1) : 0.0;
+    }
+};
+
+// Faixa de x dado o vetor de limites [l0, l1, ..., lB]: faixa i cobre [li, li+1).
+// Retorna -1 se x está fora de todas as faixas.
+inline int faixa_do_valor(const std::vector<double>& limites, double x) {
+    int faixa = static_cast<int>(std::upper_bound(limites.begin(), limites.end(), x) - limites.begin()) - 1;
+    return (faixa >= 0 && faixa < static_cast<int>(limites.size()) - 1) ? faixa : -1;
+}
+
+inline void resumo_combinar(ResumoSalarial& a, const ResumoSalarial& b) {
+    a.soma += b.soma;
+    welford_combine(a.welford, b.welford);
+    a.minimo = std::min(a.minimo, b.minimo);
+    a.maximo = std::max(a.maximo, b.maximo);
+    for (size_t f = 0; f < a.faixas.size(); ++f) {
+        a.faixas[f] += b.faixas[f];
+    }
+    a.esboco.combinar(b.esboco);
+}
+
+// Acumula um bloco contíguo no resumo (serial; chamado por cada thread sobre sua parte).
+// A parte é percorrida em blocos do tamanho da L1: welford_bloco (lanes SIMD, sem a divisão
+// por elemento do welford_update) e depois soma, mínimo, máximo, faixas e esboço sobre o
+// mesmo bloco, que já está na cache. A memória continua sendo lida uma única vez.
+inline void resumo_acumular(ResumoSalarial& r, const std::vector<double>& limites,
+                            const double* dados, size_t n) {
+    const size_t BLOCO = 4096; // 32 KiB de doubles
+    const bool comEsboco = r.esboco.ativo();
+    for (size_t inicio = 0; inicio < n; inicio += BLOCO) {
+        const double* x = dados + inicio;
+        const size_t tamanho = std::min(BLOCO, n - inicio);
+        welford_combine(r.welford, welford_bloco(x, tamanho));
+
+        double soma = 0.0, menor = r.minimo, maior = r.maximo;
+        #pragma omp simd reduction(+:soma) reduction(min:menor) reduction(max:maior)
+        for (size_t i = 0; i < tamanho; ++i) {
+            soma += x[i];
+            menor = std::min(menor, x[i]);
+            maior = std::max(maior, x[i]);
+        }
+        r.soma += soma;
+        r.minimo = menor;
+        r.maximo = maior;
+
+        if (!r.faixas.empty()) {
+            for (size_t i = 0; i < tamanho; ++i) {
+                int f = faixa_do_valor(limites, x[i]);
+                if (f >= 0) r.faixas[f]++;
+            }
+        }
+        if (comEsboco) r.esboco.adicionar_bloco(x, tamanho);
+    }
+}
+
+// Kernel fundido: uma única leitura dos dados produz todas as estatísticas.
+// Cada thread acumula em um resumo privado (incluindo as faixas) e os resumos são
+// combinados ao final, como no Welford paralelo de q2.cpp.
+// Com kEsboco > 0, os percentis aproximados saem da mesma passada (total.esboco.quantis()).
+inline ResumoSalarial resumir_salarios(const double* dados, size_t n,
+                                       const std::vector<double>& limites = {}, int kEsboco = 0) {
+    const size_t numFaixas = limites.empty() ? 0 : limites.size() - 1;
+    ResumoSalarial total(numFaixas, kEsboco);
+
+    #pragma omp parallel
+    {
+        const int t = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const size_t ini = n * t / nt;
+        const size_t fim = n * (t + 1) / nt;
+
+        ResumoSalarial local(numFaixas, kEsboco);
+        resumo_acumular(local, limites, dados + ini, fim - ini);
+
+        // Combinação em ordem de thread para resultado estável entre execuções
+        #pragma omp for ordered schedule(static, 1)
+        for (int th = 0; th < nt; ++th) {
+            #pragma omp ordered
+            resumo_combinar(total, local);
+        }
+    }
+
+    return total;
+}
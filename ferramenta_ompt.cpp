@@ -0,0 +1,348 @@
+// Ferramenta OMPT: linha do tempo das regiões paralelas de q1-q4.
+//
+// Para cada região paralela registra, por thread: trabalho (tarefa implícita), espera em
+// barreira, tempo de reduction, espera e posse de critical/lock/atomic/ordered e tempo
+// ocioso entre regiões. Grava um trace no formato Trace Event (JSON), aberto por
+// chrome://tracing, Perfetto ou speedscope, e imprime em stderr um resumo por região com
+// o desbalanceamento (trabalho máximo / trabalho médio).
+//
+// OMPT é implementado pelo runtime da LLVM (libomp); o libgomp do GCC não chama ferramentas.
+// Programas compilados com g++ rodam sobre o libomp, que exporta a ABI GOMP_*:
+//
+//   g++ -std=c++17 -O2 -fPIC -shared ferramenta_ompt.cpp -I<dir do omp-tools.h> -o libferramenta_ompt.so
+//   g++ -std=c++17 -O2 -fopenmp q2.cpp -o q2
+//   LD_PRELOAD=libomp.so.5 OMP_TOOL_LIBRARIES=./libferramenta_ompt.so ./q2
+//
+// (com clang: clang++ -fopenmp q2.cpp -o q2 && OMP_TOOL_LIBRARIES=./libferramenta_ompt.so ./q2)
+//
+// Com clang a combinação das reductions chega por ompt_callback_reduction. O GCC combina
+// as parciais no código gerado, entre GOMP_atomic_start/end, então ali ela aparece como
+// exclusão "atomic". O endereço de cada região vira linha de código com addr2line -e <programa>.
+//
+// O arquivo de saída é OMPT_TRACE_ARQUIVO (padrão: ompt_trace.json).
+#include <omp-tools.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class TipoEvento : uint8_t { TRABALHO, BARREIRA, REDUCAO, ESPERA_EXCLUSAO, EXCLUSAO, OCIOSO };
+
+const char* nome_evento(TipoEvento t) {
+    switch (t) {
+        case TipoEvento::TRABALHO: return "trabalho";
+        case TipoEvento::BARREIRA: return "barreira";
+        case TipoEvento::REDUCAO: return "reduction";
+        case TipoEvento::ESPERA_EXCLUSAO: return "espera exclusao";
+        case TipoEvento::EXCLUSAO: return "exclusao";
+        default: return "ocioso";
+    }
+}
+
+struct Evento {
+    TipoEvento tipo;
+    uint64_t regiao;
+    int64_t inicio_ns;
+    int64_t duracao_ns;
+    const char* detalhe;  // tipo de exclusão (critical, lock, ...) ou nullptr
+};
+
+// Estado de uma thread: só a própria thread escreve; o resumo lê no finalize
+struct EstadoThread {
+    int id = 0;
+    bool trabalhadora = false;
+    std::vector<Evento> eventos;
+
+    uint64_t regiao_atual = 0;
+    int64_t inicio_tarefa = -1;
+    int64_t fim_ultima_tarefa = -1;
+    int64_t inicio_barreira = -1;
+    int64_t inicio_reducao = -1;
+    int64_t inicio_espera = -1;
+    int64_t inicio_posse = -1;
+};
+
+struct Regiao {
+    const void* codigo = nullptr;
+    unsigned threads = 0;
+    int64_t inicio_ns = 0;
+    int64_t fim_ns = 0;
+};
+
+// Estado global alocado em inicializar() e nunca destruído: o runtime chama finalizar()
+// no próprio destrutor, depois que os objetos estáticos desta biblioteca já podem ter sido
+// destruídos
+struct Global {
+    std::chrono::steady_clock::time_point origem;
+    std::mutex trava;
+    std::vector<EstadoThread*> threads;
+    std::map<uint64_t, Regiao> regioes;
+    std::atomic<uint64_t> proxima_regiao{1};
+    std::atomic<int> proxima_thread{0};
+};
+
+Global* global = nullptr;
+ompt_get_thread_data_t obter_dados_thread = nullptr;
+
+int64_t agora() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - global->origem).count();
+}
+
+EstadoThread* estado_atual() {
+    if (obter_dados_thread == nullptr) return nullptr;
+    ompt_data_t* dados = obter_dados_thread();
+    return dados != nullptr ? static_cast<EstadoThread*>(dados->ptr) : nullptr;
+}
+
+void registrar(EstadoThread* e, TipoEvento tipo, int64_t inicio, int64_t fim, const char* detalhe = nullptr) {
+    if (e == nullptr || inicio < 0 || fim < inicio) return;
+    e->eventos.push_back({tipo, e->regiao_atual, inicio, fim - inicio, detalhe});
+}
+
+const char* nome_exclusao(ompt_mutex_t tipo) {
+    switch (tipo) {
+        case ompt_mutex_critical: return "critical";
+        case ompt_mutex_atomic: return "atomic";
+        case ompt_mutex_ordered: return "ordered";
+        default: return "lock";
+    }
+}
+
+// ---- callbacks ----
+
+void ao_iniciar_thread(ompt_thread_t tipo, ompt_data_t* dados) {
+    EstadoThread* e = new EstadoThread();
+    e->id = global->proxima_thread.fetch_add(1);
+    e->trabalhadora = tipo == ompt_thread_worker;
+    e->eventos.reserve(1 << 12);
+    dados->ptr = e;
+    std::lock_guard<std::mutex> guarda(global->trava);
+    global->threads.push_back(e);
+}
+
+void ao_iniciar_regiao(ompt_data_t*, const ompt_frame_t*, ompt_data_t* regiao, unsigned threads, int,
+                       const void* codigo) {
+    const uint64_t id = global->proxima_regiao.fetch_add(1);
+    regiao->value = id;
+    std::lock_guard<std::mutex> guarda(global->trava);
+    Regiao& r = global->regioes[id];
+    r.codigo = codigo;
+    r.threads = threads;
+    r.inicio_ns = agora();
+}
+
+void ao_terminar_regiao(ompt_data_t* regiao, ompt_data_t*, int, const void*) {
+    const int64_t t = agora();
+    std::lock_guard<std::mutex> guarda(global->trava);
+    global->regioes[regiao->value].fim_ns = t;
+}
+
+void ao_tarefa_implicita(ompt_scope_endpoint_t ponto, ompt_data_t* regiao, ompt_data_t*, unsigned threads,
+                         unsigned, int flags) {
+    if (flags & ompt_task_initial) return;
+    EstadoThread* e = estado_atual();
+    if (e == nullptr) return;
+    const int64_t t = agora();
+    if (ponto == ompt_scope_begin) {
+        if (e->trabalhadora && e->fim_ultima_tarefa >= 0) {
+            e->regiao_atual = 0;
+            registrar(e, TipoEvento::OCIOSO, e->fim_ultima_tarefa, t);
+        }
+        e->regiao_atual = regiao != nullptr ? regiao->value : 0;
+        e->inicio_tarefa = t;
+        if (regiao != nullptr && threads > 0) {
+            std::lock_guard<std::mutex> guarda(global->trava);
+            global->regioes[regiao->value].threads = threads;
+        }
+    } else {
+        registrar(e, TipoEvento::TRABALHO, e->inicio_tarefa, t);
+        e->inicio_tarefa = -1;
+        e->fim_ultima_tarefa = t;
+    }
+}
+
+void ao_esperar_sincronizacao(ompt_sync_region_t tipo, ompt_scope_endpoint_t ponto, ompt_data_t*, ompt_data_t*,
+                              const void*) {
+    // barrier_implementation é a barreira de fork/join do runtime, onde as threads esperam
+    // entre regiões: já entra como tempo ocioso
+    if (tipo == ompt_sync_region_taskwait || tipo == ompt_sync_region_taskgroup ||
+        tipo == ompt_sync_region_reduction || tipo == ompt_sync_region_barrier_implementation) {
+        return;
+    }
+    EstadoThread* e = estado_atual();
+    if (e == nullptr) return;
+    if (ponto == ompt_scope_begin) {
+        e->inicio_barreira = agora();
+    } else {
+        registrar(e, TipoEvento::BARREIRA, e->inicio_barreira, agora());
+        e->inicio_barreira = -1;
+    }
+}
+
+void ao_reduzir(ompt_sync_region_t, ompt_scope_endpoint_t ponto, ompt_data_t*, ompt_data_t*, const void*) {
+    EstadoThread* e = estado_atual();
+    if (e == nullptr) return;
+    if (ponto == ompt_scope_begin) {
+        e->inicio_reducao = agora();
+    } else {
+        registrar(e, TipoEvento::REDUCAO, e->inicio_reducao, agora());
+        e->inicio_reducao = -1;
+    }
+}
+
+void ao_pedir_exclusao(ompt_mutex_t, unsigned, unsigned, ompt_wait_id_t, const void*) {
+    if (EstadoThread* e = estado_atual()) e->inicio_espera = agora();
+}
+
+void ao_obter_exclusao(ompt_mutex_t tipo, ompt_wait_id_t, const void*) {
+    EstadoThread* e = estado_atual();
+    if (e == nullptr) return;
+    const int64_t t = agora();
+    registrar(e, TipoEvento::ESPERA_EXCLUSAO, e->inicio_espera, t, nome_exclusao(tipo));
+    e->inicio_espera = -1;
+    e->inicio_posse = t;
+}
+
+void ao_liberar_exclusao(ompt_mutex_t tipo, ompt_wait_id_t, const void*) {
+    EstadoThread* e = estado_atual();
+    if (e == nullptr) return;
+    registrar(e, TipoEvento::EXCLUSAO, e->inicio_posse, agora(), nome_exclusao(tipo));
+    e->inicio_posse = -1;
+}
+
+// ---- saída ----
+
+struct Totais {
+    double trabalho = 0, barreira = 0, reducao = 0, espera = 0, exclusao = 0;
+};
+
+void escrever_trace(const char* caminho) {
+    FILE* f = std::fopen(caminho, "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "[ompt] não foi possível abrir %s\n", caminho);
+        return;
+    }
+    std::fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    bool primeiro = true;
+    auto separador = [&] {
+        if (!primeiro) std::fprintf(f, ",\n");
+        primeiro = false;
+    };
+
+    for (const EstadoThread* e : global->threads) {
+        separador();
+        std::fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                        "\"args\": {\"name\": \"%s %d\"}}", e->id, e->trabalhadora ? "trabalhadora" : "principal", e->id);
+        for (const Evento& ev : e->eventos) {
+            separador();
+            std::fprintf(f, "{\"name\": \"%s%s%s\", \"cat\": \"ompt\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"regiao\": %llu}}",
+                         nome_evento(ev.tipo), ev.detalhe ? " " : "", ev.detalhe ? ev.detalhe : "", e->id,
+                         ev.inicio_ns / 1e3, ev.duracao_ns / 1e3, static_cast<unsigned long long>(ev.regiao));
+        }
+    }
+    for (const auto& [id, r] : global->regioes) {
+        if (r.fim_ns <= r.inicio_ns) continue;
+        separador();
+        std::fprintf(f, "{\"name\": \"regiao %llu (%p)\", \"cat\": \"regiao\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, "
+                        "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"threads\": %u}}",
+                     static_cast<unsigned long long>(id), r.codigo, r.inicio_ns / 1e3,
+                     (r.fim_ns - r.inicio_ns) / 1e3, r.threads);
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+}
+
+void imprimir_resumo() {
+    // (região, thread) -> totais
+    std::map<uint64_t, std::map<int, Totais>> por_regiao;
+    std::map<int, double> ocioso;
+    for (const EstadoThread* e : global->threads) {
+        for (const Evento& ev : e->eventos) {
+            const double s = ev.duracao_ns * 1e-9;
+            if (ev.tipo == TipoEvento::OCIOSO) {
+                ocioso[e->id] += s;
+                continue;
+            }
+            Totais& t = por_regiao[ev.regiao][e->id];
+            switch (ev.tipo) {
+                case TipoEvento::TRABALHO: t.trabalho += s; break;
+                case TipoEvento::BARREIRA: t.barreira += s; break;
+                case TipoEvento::REDUCAO: t.reducao += s; break;
+                case TipoEvento::ESPERA_EXCLUSAO: t.espera += s; break;
+                case TipoEvento::EXCLUSAO: t.exclusao += s; break;
+                default: break;
+            }
+        }
+    }
+
+    std::fprintf(stderr, "[ompt] %-6s %-18s %7s %11s %11s %11s %11s %11s %11s %8s\n", "regiao", "codigo", "threads",
+                 "duracao_ms", "util_ms", "barreira_ms", "reducao_ms", "esp_excl_ms", "excl_ms", "desbal.");
+    for (const auto& [id, threads] : por_regiao) {
+        const Regiao& r = global->regioes[id];
+        Totais soma;
+        double maior_util = 0.0;
+        for (const auto& [tid, t] : threads) {
+            // Trabalho útil: tarefa implícita menos as esperas contidas nela
+            const double util = t.trabalho - t.barreira - t.reducao - t.espera;
+            maior_util = std::max(maior_util, util);
+            soma.trabalho += util;
+            soma.barreira += t.barreira;
+            soma.reducao += t.reducao;
+            soma.espera += t.espera;
+            soma.exclusao += t.exclusao;
+        }
+        const double media_util = soma.trabalho / threads.size();
+        std::fprintf(stderr, "[ompt] %-6llu %-18p %7zu %11.3f %11.3f %11.3f %11.3f %11.3f %11.3f %8.2f\n",
+                     static_cast<unsigned long long>(id), r.codigo, threads.size(), (r.fim_ns - r.inicio_ns) * 1e-6,
+                     soma.trabalho * 1e3, soma.barreira * 1e3, soma.reducao * 1e3, soma.espera * 1e3,
+                     soma.exclusao * 1e3, media_util > 0 ? maior_util / media_util : 1.0);
+    }
+    for (const auto& [tid, s] : ocioso) {
+        std::fprintf(stderr, "[ompt] thread %d ociosa entre regiões: %.3f ms\n", tid, s * 1e3);
+    }
+}
+
+int inicializar(ompt_function_lookup_t buscar, int, ompt_data_t*) {
+    global = new Global();
+    global->origem = std::chrono::steady_clock::now();
+    auto definir = reinterpret_cast<ompt_set_callback_t>(buscar("ompt_set_callback"));
+    obter_dados_thread = reinterpret_cast<ompt_get_thread_data_t>(buscar("ompt_get_thread_data"));
+    if (definir == nullptr || obter_dados_thread == nullptr) return 0;
+
+    definir(ompt_callback_thread_begin, reinterpret_cast<ompt_callback_t>(&ao_iniciar_thread));
+    definir(ompt_callback_parallel_begin, reinterpret_cast<ompt_callback_t>(&ao_iniciar_regiao));
+    definir(ompt_callback_parallel_end, reinterpret_cast<ompt_callback_t>(&ao_terminar_regiao));
+    definir(ompt_callback_implicit_task, reinterpret_cast<ompt_callback_t>(&ao_tarefa_implicita));
+    definir(ompt_callback_sync_region_wait, reinterpret_cast<ompt_callback_t>(&ao_esperar_sincronizacao));
+    definir(ompt_callback_reduction, reinterpret_cast<ompt_callback_t>(&ao_reduzir));
+    definir(ompt_callback_mutex_acquire, reinterpret_cast<ompt_callback_t>(&ao_pedir_exclusao));
+    definir(ompt_callback_mutex_acquired, reinterpret_cast<ompt_callback_t>(&ao_obter_exclusao));
+    definir(ompt_callback_mutex_released, reinterpret_cast<ompt_callback_t>(&ao_liberar_exclusao));
+    return 1;  // diferente de zero: ferramenta ativa
+}
+
+void finalizar(ompt_data_t*) {
+    std::lock_guard<std::mutex> guarda(global->trava);
+    const char* caminho = std::getenv("OMPT_TRACE_ARQUIVO");
+    escrever_trace(caminho != nullptr ? caminho : "ompt_trace.json");
+    imprimir_resumo();
+}
+
+ompt_start_tool_result_t resultado = {&inicializar, &finalizar, {0}};
+
+} // namespace
+
+// Ponto de entrada procurado pelo runtime nas bibliotecas de OMP_TOOL_LIBRARIES
+extern "C" ompt_start_tool_result_t* ompt_start_tool(unsigned int, const char*) {
+    return &resultado;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tabela colunar (SoA) de funcionários: cada campo fica em um vetor contíguo, então um
+// laço que só lê salario ou idade não traz os outros campos para a cache.
+// Os nomes ficam todos em uma única arena; o nome i ocupa
+// arena_nomes[inicio_nome[i], inicio_nome[i + 1]).
+struct TabelaFuncionarios {
+    std::vector<double> salario;
+    std::vector<int> departamento;
+    std::vector<int> idade;
+    std::vector<double> horas_trabalhadas;
+
+    std::string arena_nomes;
+    std::vector<size_t> inicio_nome;
+
+    size_t tamanho() const { return salario.size(); }
+
+    // Aloca as colunas numéricas para n linhas (a arena de nomes é montada à parte)
+    void redimensionar(size_t n) {
+        salario.resize(n);
+        departamento.resize(n);
+        idade.resize(n);
+        horas_trabalhadas.resize(n);
+        inicio_nome.assign(n + 1, 0);
+    }
+
+    std::string_view nome(size_t i) const {
+        return std::string_view(arena_nomes).substr(inicio_nome[i], inicio_nome[i + 1] - inicio_nome[i]);
+    }
+};
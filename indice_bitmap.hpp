@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "funcionarios.hpp"
+#include "auditoria.hpp"
+
+// Bitmap compactado no estilo Roaring: os índices são divididos em blocos de 2^16
+// (chave = 16 bits altos). Cada bloco guarda os 16 bits baixos como vetor ordenado
+// enquanto tem até LIMITE_VETOR elementos, ou como bitmap de 1024 palavras quando é denso.
+class BitmapCompactado {
+public:
+    static constexpr size_t LIMITE_VETOR = 4096;
+    static constexpr size_t PALAVRAS = 65536 / 64;
+
+    struct Container {
+        uint16_t chave = 0;
+        uint32_t cardinalidade = 0;
+        std::vector<uint16_t> valores;  // usado quando esparso
+        std::vector<uint64_t> bits;     // usado quando denso (PALAVRAS palavras)
+
+        bool denso() const { return !bits.empty(); }
+
+        bool contem(uint16_t baixo) const {
+            if (denso()) return (bits[baixo >> 6] >> (baixo & 63)) & 1;
+            return std::binary_search(valores.begin(), valores.end(), baixo);
+        }
+
+        // Escolhe a representação certa para a cardinalidade atual
+        void normalizar() {
+            if (denso() && cardinalidade <= LIMITE_VETOR) {
+                valores.clear();
+                valores.reserve(cardinalidade);
+                for (size_t w = 0; w < PALAVRAS; ++w) {
+                    for (uint64_t palavra = bits[w]; palavra; palavra &= palavra - 1) {
+                        valores.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(palavra)));
+                    }
+                }
+                bits.clear();
+                bits.shrink_to_fit();
+            } else if (!denso() && cardinalidade > LIMITE_VETOR) {
+                bits.assign(PALAVRAS, 0);
+                for (uint16_t v : valores) bits[v >> 6] |= 1ULL << (v & 63);
+                valores.clear();
+                valores.shrink_to_fit();
+            }
+        }
+    };
+
+    BitmapCompactado() = default;
+
+    // Constrói a partir de containers já ordenados por chave (containers vazios são descartados)
+    explicit BitmapCompactado(std::vector<Container> blocos) {
+        for (auto& c : blocos) {
+            if (c.cardinalidade > 0) containers.push_back(std::move(c));
+        }
+    }
+
+    size_t cardinalidade() const {
+        size_t total = 0;
+        for (const auto& c : containers) total += c.cardinalidade;
+        return total;
+    }
+
+    bool contem(uint32_t indice) const {
+        auto it = std::lower_bound(containers.begin(), containers.end(), static_cast<uint16_t>(indice >> 16),
+                                   [](const Container& c, uint16_t chave) { return c.chave < chave; });
+        return it != containers.end() && it->chave == (indice >> 16) && it->contem(static_cast<uint16_t>(indice));
+    }
+
+    // Maior índice presente (o bitmap não pode estar vazio)
+    uint32_t maximo() const {
+        const Container& c = containers.back();
+        uint32_t baixo = 0;
+        if (c.denso()) {
+            size_t w = PALAVRAS - 1;
+            while (c.bits[w] == 0) --w;
+            baixo = static_cast<uint32_t>(w * 64 + 63 - __builtin_clzll(c.bits[w]));
+        } else {
+            baixo = c.valores.back();
+        }
+        return (static_cast<uint32_t>(c.chave) << 16) | baixo;
+    }
+
+    // Índices em ordem crescente (até limite elementos)
+    std::vector<uint32_t> para_vetor(size_t limite = SIZE_MAX) const {
+        std::vector<uint32_t> saida;
+        for (const auto& c : containers) {
+            const uint32_t base = static_cast<uint32_t>(c.chave) << 16;
+            if (c.denso()) {
+                for (size_t w = 0; w < PALAVRAS && saida.size() < limite; ++w) {
+                    for (uint64_t palavra = c.bits[w]; palavra && saida.size() < limite; palavra &= palavra - 1) {
+                        saida.push_back(base | static_cast<uint32_t>(w * 64 + __builtin_ctzll(palavra)));
+                    }
+                }
+            } else {
+                for (size_t k = 0; k < c.valores.size() && saida.size() < limite; ++k) {
+                    saida.push_back(base | c.valores[k]);
+                }
+            }
+            if (saida.size() >= limite) break;
+        }
+        return saida;
+    }
+
+    friend BitmapCompactado operator&(const BitmapCompactado& a, const BitmapCompactado& b) {
+        return combinar(a, b, true);
+    }
+
+    friend BitmapCompactado operator|(const BitmapCompactado& a, const BitmapCompactado& b) {
+        return combinar(a, b, false);
+    }
+
+    void salvar(std::ostream& saida) const {
+        uint32_t quantidade = static_cast<uint32_t>(containers.size());
+        saida.write(reinterpret_cast<const char*>(&quantidade), sizeof(quantidade));
+        for (const auto& c : containers) {
+            uint8_t denso = c.denso();
+            saida.write(reinterpret_cast<const char*>(&c.chave), sizeof(c.chave));
+            saida.write(reinterpret_cast<const char*>(&c.cardinalidade), sizeof(c.cardinalidade));
+            saida.write(reinterpret_cast<const char*>(&denso), sizeof(denso));
+            if (denso) {
+                saida.write(reinterpret_cast<const char*>(c.bits.data()), PALAVRAS * sizeof(uint64_t));
+            } else {
+                saida.write(reinterpret_cast<const char*>(c.valores.data()), c.valores.size() * sizeof(uint16_t));
+            }
+        }
+    }
+
+    // Lê o formato de salvar e confere a estrutura que contem, para_vetor e as operações
+    // supõem (chaves crescentes, representação coerente com a cardinalidade, valores
+    // ordenados); arquivo truncado ou corrompido lança std::runtime_error.
+    void carregar(std::istream& entrada) {
+        auto ler = [&entrada](void* destino, size_t bytes) {
+            entrada.read(static_cast<char*>(destino), static_cast<std::streamsize>(bytes));
+            if (!entrada) throw std::runtime_error("índice truncado");
+        };
+        auto corrompido = [](const std::string& motivo) { return std::runtime_error("índice corrompido: " + motivo); };
+
+        uint32_t quantidade = 0;
+        ler(&quantidade, sizeof(quantidade));
+        if (quantidade > 65536) throw corrompido(std::to_string(quantidade) + " blocos");
+
+        std::vector<Container> lidos(quantidade);
+        for (size_t k = 0; k < lidos.size(); ++k) {
+            Container& c = lidos[k];
+            uint8_t denso = 0;
+            ler(&c.chave, sizeof(c.chave));
+            ler(&c.cardinalidade, sizeof(c.cardinalidade));
+            ler(&denso, sizeof(denso));
+            if (k > 0 && c.chave <= lidos[k - 1].chave) throw corrompido("blocos fora de ordem");
+            if (denso > 1 || c.cardinalidade == 0 || c.cardinalidade > 65536 ||
+                (denso != 0) != (c.cardinalidade > LIMITE_VETOR)) {
+                throw corrompido("bloco " + std::to_string(c.chave) + " com cardinalidade " +
+                                 std::to_string(c.cardinalidade));
+            }
+            if (denso) {
+                c.bits.resize(PALAVRAS);
+                ler(c.bits.data(), PALAVRAS * sizeof(uint64_t));
+                size_t total = 0;
+                for (uint64_t palavra : c.bits) total += __builtin_popcountll(palavra);
+                if (total != c.cardinalidade) throw corrompido("bloco " + std::to_string(c.chave) + " com contagem errada");
+            } else {
+                c.valores.resize(c.cardinalidade);
+                ler(c.valores.data(), c.cardinalidade * sizeof(uint16_t));
+                if (std::adjacent_find(c.valores.begin(), c.valores.end(), std::greater_equal<uint16_t>()) !=
+                    c.valores.end()) {
+                    throw corrompido("bloco " + std::to_string(c.chave) + " fora de ordem");
+                }
+            }
+        }
+        containers = std::move(lidos);
+    }
+
+private:
+    std::vector<Container> containers; // ordenados por chave
+
+    static Container combinar_container(const Container& a, const Container& b, bool intersecao) {
+        Container r;
+        r.chave = a.chave;
+        if (a.denso() && b.denso()) {
+            r.bits.resize(PALAVRAS);
+            uint32_t total = 0;
+            #pragma omp simd reduction(+:total)
+            for (size_t w = 0; w < PALAVRAS; ++w) {
+                r.bits[w] = intersecao ? (a.bits[w] & b.bits[w]) : (a.bits[w] | b.bits[w]);
+                total += __builtin_popcountll(r.bits[w]);
+            }
+            r.cardinalidade = total;
+        } else if (!a.denso() && !b.denso()) {
+            if (intersecao) {
+                std::set_intersection(a.valores.begin(), a.valores.end(), b.valores.begin(), b.valores.end(),
+                                      std::back_inserter(r.valores));
+            } else {
+                std::set_union(a.valores.begin(), a.valores.end(), b.valores.begin(), b.valores.end(),
+                               std::back_inserter(r.valores));
+            }
+            r.cardinalidade = static_cast<uint32_t>(r.valores.size());
+        } else {
+            const Container& esparso = a.denso() ? b : a;
+            const Container& denso = a.denso() ? a : b;
+            if (intersecao) {
+                for (uint16_t v : esparso.valores) {
+                    if (denso.contem(v)) r.valores.push_back(v);
+                }
+                r.cardinalidade = static_cast<uint32_t>(r.valores.size());
+            } else {
+                r.bits = denso.bits;
+                r.cardinalidade = denso.cardinalidade;
+                for (uint16_t v : esparso.valores) {
+                    uint64_t bit = 1ULL << (v & 63);
+                    r.cardinalidade += (r.bits[v >> 6] & bit) == 0;
+                    r.bits[v >> 6] |= bit;
+                }
+            }
+        }
+        r.normalizar();
+        return r;
+    }
+
+    static BitmapCompactado combinar(const BitmapCompactado& a, const BitmapCompactado& b, bool intersecao) {
+        // Emparelha os containers por chave; os sem par só entram na união
+        std::vector<std::pair<const Container*, const Container*>> pares;
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() || j < b.containers.size()) {
+            const Container* ca = i < a.containers.size() ? &a.containers[i] : nullptr;
+            const Container* cb = j < b.containers.size() ? &b.containers[j] : nullptr;
+            if (ca && cb && ca->chave == cb->chave) {
+                pares.emplace_back(ca, cb);
+                ++i;
+                ++j;
+            } else if (cb == nullptr || (ca && ca->chave < cb->chave)) {
+                if (!intersecao) pares.emplace_back(ca, nullptr);
+                ++i;
+            } else {
+                if (!intersecao) pares.emplace_back(cb, nullptr);
+                ++j;
+            }
+        }
+
+        std::vector<Container> resultado(pares.size());
+        #pragma omp parallel for schedule(dynamic, 4) if(pares.size() > 16)
+        for (size_t p = 0; p < pares.size(); ++p) {
+            resultado[p] = pares[p].second ? combinar_container(*pares[p].first, *pares[p].second, intersecao)
+                                           : *pares[p].first;
+        }
+        return BitmapCompactado(std::move(resultado));
+    }
+};
+
+// Índice de drill-down da auditoria: um bitmap por regra (bit de BitViolacao) e um por
+// departamento. Consultas como "viola piso E horas no departamento 3" viram operações
+// entre bitmaps, sem reler a tabela.
+//
+// Arquivo (salvar/carregar): assinatura "OMPIDX1\0", uint64 linhas da tabela, uint32 número de
+// departamentos e os bitmaps (regras, depois departamentos) no formato de BitmapCompactado.
+class IndiceAuditoria {
+public:
+    static constexpr int NUM_REGRAS = 6;
+    static constexpr uint32_t MAX_DEPARTAMENTOS = 65536;
+
+    // Linhas da tabela indexada: todo índice dos bitmaps é menor que isso
+    size_t linhas() const { return linhas_; }
+
+    const BitmapCompactado& regra(BitViolacao bit) const { return por_regra[__builtin_ctz(bit)]; }
+
+    const BitmapCompactado& departamento(int d) const {
+        static const BitmapCompactado vazio;
+        return (d >= 0 && d < static_cast<int>(por_departamento.size())) ? por_departamento[d] : vazio;
+    }
+
+    // Um bloco de 2^16 linhas por iteração: cada thread monta os containers daquele bloco
+    // para todas as regras e departamentos enquanto a máscara e a coluna estão na cache.
+    static IndiceAuditoria construir(const TabelaFuncionarios& tabela, const ResultadoAuditoria& auditoria) {
+        const size_t n = tabela.tamanho();
+        const size_t numBlocos = (n + 65535) / 65536;
+        const int* departamento = tabela.departamento.data();
+        const uint8_t* mascara = auditoria.mascara.data();
+
+        int maiorDepartamento = -1;
+        #pragma omp parallel for reduction(max:maiorDepartamento)
+        for (size_t i = 0; i < n; ++i) {
+            maiorDepartamento = std::max(maiorDepartamento, departamento[i]);
+        }
+        const int numDepartamentos = maiorDepartamento + 1;
+
+        std::vector<std::vector<BitmapCompactado::Container>> regras(
+            NUM_REGRAS, std::vector<BitmapCompactado::Container>(numBlocos));
+        std::vector<std::vector<BitmapCompactado::Container>> departamentos(
+            numDepartamentos, std::vector<BitmapCompactado::Container>(numBlocos));
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t bloco = 0; bloco < numBlocos; ++bloco) {
+            const size_t inicio = bloco << 16;
+            const size_t fim = std::min(n, inicio + 65536);
+            for (int r = 0; r < NUM_REGRAS; ++r) regras[r][bloco].chave = static_cast<uint16_t>(bloco);
+            for (int d = 0; d < numDepartamentos; ++d) departamentos[d][bloco].chave = static_cast<uint16_t>(bloco);
+
+            for (size_t i = inicio; i < fim; ++i) {
+                const uint16_t baixo = static_cast<uint16_t>(i - inicio);
+                for (uint8_t m = mascara[i]; m; m &= m - 1) {
+                    regras[__builtin_ctz(m)][bloco].valores.push_back(baixo);
+                }
+                if (departamento[i] >= 0) departamentos[departamento[i]][bloco].valores.push_back(baixo);
+            }
+
+            for (int r = 0; r < NUM_REGRAS; ++r) {
+                auto& c = regras[r][bloco];
+                c.cardinalidade = static_cast<uint32_t>(c.valores.size());
+                c.normalizar();
+            }
+            for (int d = 0; d < numDepartamentos; ++d) {
+                auto& c = departamentos[d][bloco];
+                c.cardinalidade = static_cast<uint32_t>(c.valores.size());
+                c.normalizar();
+            }
+        }
+
+        IndiceAuditoria indice;
+        indice.linhas_ = n;
+        for (auto& blocos : regras) indice.por_regra.emplace_back(std::move(blocos));
+        for (auto& blocos : departamentos) indice.por_departamento.emplace_back(std::move(blocos));
+        return indice;
+    }
+
+    void salvar(std::ostream& saida) const {
+        const uint64_t linhas = linhas_;
+        const uint32_t numDepartamentos = static_cast<uint32_t>(por_departamento.size());
+        saida.write(ASSINATURA, sizeof(ASSINATURA));
+        saida.write(reinterpret_cast<const char*>(&linhas), sizeof(linhas));
+        saida.write(reinterpret_cast<const char*>(&numDepartamentos), sizeof(numDepartamentos));
+        for (const auto& b : por_regra) b.salvar(saida);
+        for (const auto& b : por_departamento) b.salvar(saida);
+    }
+
+    // Lança std::runtime_error se o arquivo não for um índice, estiver truncado ou tiver
+    // índices fora das linhas declaradas; o índice atual só é trocado se a leitura terminar
+    void carregar(std::istream& entrada) {
+        char assinatura[sizeof(ASSINATURA)] = {};
+        uint64_t linhas = 0;
+        uint32_t numDepartamentos = 0;
+        entrada.read(assinatura, sizeof(assinatura));
+        entrada.read(reinterpret_cast<char*>(&linhas), sizeof(linhas));
+        entrada.read(reinterpret_cast<char*>(&numDepartamentos), sizeof(numDepartamentos));
+        if (!entrada || std::memcmp(assinatura, ASSINATURA, sizeof(ASSINATURA)) != 0) {
+            throw std::runtime_error("arquivo não é um índice de auditoria");
+        }
+        if (linhas > (uint64_t(1) << 32) || numDepartamentos > MAX_DEPARTAMENTOS) {
+            throw std::runtime_error("índice corrompido: " + std::to_string(linhas) + " linhas, " +
+                                     std::to_string(numDepartamentos) + " departamentos");
+        }
+
+        IndiceAuditoria lido;
+        lido.linhas_ = linhas;
+        lido.por_regra.resize(NUM_REGRAS);
+        lido.por_departamento.resize(numDepartamentos);
+        for (auto* grupo : {&lido.por_regra, &lido.por_departamento}) {
+            for (auto& b : *grupo) {
+                b.carregar(entrada);
+                if (b.cardinalidade() > 0 && b.maximo() >= linhas) {
+                    throw std::runtime_error("índice corrompido: linha " + std::to_string(b.maximo()) +
+                                             " além das " + std::to_string(linhas) + " da tabela");
+                }
+            }
+        }
+        *this = std::move(lido);
+    }
+
+private:
+    static constexpr char ASSINATURA[8] = {'O', 'M', 'P', 'I', 'D', 'X', '1', '\0'};
+
+    size_t linhas_ = 0;
+    std::vector<BitmapCompactado> por_regra;
+    std::vector<BitmapCompactado> por_departamento;
+};
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <omp.h>
+
+#include "funcionarios.hpp"
+#include "numa.hpp"
+
+// Ingestão paralela de CSV (exportações de folha de pagamento) direto nas colunas.
+//
+// O arquivo é mapeado com mmap e dividido em blocos de alguns MB; cada fronteira avança até
+// depois do próximo '\n', então toda linha cai inteira num bloco. Duas passadas paralelas:
+//   1. cada bloco conta suas linhas de dados (linhas vazias não contam);
+//   2. depois da soma de prefixos, cada bloco sabe a linha da tabela onde começa e converte
+//      seus campos com std::from_chars (sem locale, sem iostream) direto nas colunas.
+// Os nomes vão para uma arena por bloco e são concatenados em paralelo na arena da tabela.
+//
+// A primeira linha é o cabeçalho, e as colunas são localizadas pelo nome, em qualquer ordem.
+// Campos entre aspas são aceitos (sem quebra de linha dentro deles; "" vira "). Uma linha
+// malformada interrompe a ingestão com std::runtime_error indicando a linha do arquivo.
+
+struct OpcoesCsv {
+    char separador = ',';
+    // Códigos de departamento aceitos: 0..maior_departamento. Fora disso a linha é
+    // malformada (o group-by e o índice de auditoria alocam um grupo por código).
+    int maior_departamento = 255;
+};
+
+struct ResumoIngestao {
+    size_t linhas = 0;
+    size_t bytes = 0;
+    double segundos = 0.0;
+
+    double mb_por_s() const { return segundos > 0 ? bytes / segundos / 1e6 : 0.0; }
+};
+
+namespace detalhe_csv {
+
+const size_t BYTES_POR_BLOCO = size_t(4) << 20;
+
+// Arquivo inteiro mapeado somente para leitura
+class ArquivoMapeado {
+public:
+    explicit ArquivoMapeado(const std::string& caminho) {
+        int fd = open(caminho.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("não foi possível abrir " + caminho);
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("não foi possível ler o tamanho de " + caminho);
+        }
+        tamanho_ = static_cast<size_t>(info.st_size);
+        if (tamanho_ > 0) {
+            void* p = mmap(nullptr, tamanho_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("mmap falhou em " + caminho);
+            }
+            madvise(p, tamanho_, MADV_SEQUENTIAL);
+            dados_ = static_cast<const char*>(p);
+        }
+        close(fd);
+    }
+    ArquivoMapeado(const ArquivoMapeado&) = delete;
+    ArquivoMapeado& operator=(const ArquivoMapeado&) = delete;
+    ~ArquivoMapeado() {
+        if (dados_ != nullptr) munmap(const_cast<char*>(dados_), tamanho_);
+    }
+
+    std::string_view texto() const { return std::string_view(dados_, tamanho_); }
+
+private:
+    const char* dados_ = nullptr;
+    size_t tamanho_ = 0;
+};
+
+// Próxima linha de `texto` a partir de `pos` (sem o '\n' e sem um '\r' final)
+inline bool proxima_linha(std::string_view texto, size_t& pos, std::string_view& linha) {
+    if (pos >= texto.size()) return false;
+    const char* inicio = texto.data() + pos;
+    const void* nl = std::memchr(inicio, '\n', texto.size() - pos);
+    size_t fim = nl ? static_cast<size_t>(static_cast<const char*>(nl) - texto.data()) : texto.size();
+    linha = texto.substr(pos, fim - pos);
+    if (!linha.empty() && linha.back() == '\r') linha.remove_suffix(1);
+    pos = fim + 1;
+    return true;
+}
+
+inline std::string_view aparar(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Divide uma linha em campos (aparados). Campos entre aspas voltam com as aspas externas;
+// anexar_texto as remove. Falha só com aspas sem fechamento.
+inline bool dividir_campos(std::string_view linha, char separador, std::vector<std::string_view>& campos) {
+    campos.clear();
+    size_t pos = 0;
+    while (true) {
+        size_t inicio = pos;
+        while (pos < linha.size() && (linha[pos] == ' ' || linha[pos] == '\t')) ++pos;
+        if (pos < linha.size() && linha[pos] == '"') {
+            ++pos;
+            while (true) {
+                if (pos >= linha.size()) return false;  // aspas sem fechamento
+                if (linha[pos] == '"') {
+                    if (pos + 1 < linha.size() && linha[pos + 1] == '"') pos += 2;
+                    else break;
+                } else {
+                    ++pos;
+                }
+            }
+            ++pos;
+        }
+        size_t fim = linha.find(separador, pos);
+        if (fim == std::string_view::npos) fim = linha.size();
+        campos.push_back(aparar(linha.substr(inicio, fim - inicio)));
+        if (fim == linha.size()) return true;
+        pos = fim + 1;
+    }
+}
+
+// Conteúdo de um campo de texto, sem aspas externas e com "" convertido em "
+inline void anexar_texto(std::string_view campo, std::string& destino) {
+    if (campo.size() >= 2 && campo.front() == '"' && campo.back() == '"') {
+        campo = campo.substr(1, campo.size() - 2);
+        for (size_t i = 0; i < campo.size(); ++i) {
+            destino += campo[i];
+            if (campo[i] == '"' && i + 1 < campo.size() && campo[i + 1] == '"') ++i;
+        }
+    } else {
+        destino.append(campo.data(), campo.size());
+    }
+}
+
+template <typename T>
+inline bool converter(std::string_view campo, T& valor) {
+    if (!campo.empty() && campo.front() == '+') campo.remove_prefix(1);
+    auto r = std::from_chars(campo.data(), campo.data() + campo.size(), valor);
+    return r.ec == std::errc() && r.ptr == campo.data() + campo.size();
+}
+
+// Blocos de dados (depois do cabeçalho), cada um começando no início de uma linha
+struct Bloco {
+    std::string_view texto;
+    size_t primeira_linha_arquivo = 0;  // numeração do arquivo, para mensagens de erro
+    size_t linhas_dados = 0;            // passada 1
+    size_t primeira_linha_tabela = 0;   // soma de prefixos
+    size_t linha_com_erro = 0;          // 0: sem erro
+    std::string arena_nomes;
+    std::vector<size_t> tamanho_nome;
+};
+
+// Índice de cada coluna pedida no cabeçalho (-1 se ausente)
+inline std::vector<int> localizar_colunas(std::string_view cabecalho, char separador,
+                                          const std::vector<std::string>& nomes) {
+    std::vector<std::string_view> campos;
+    if (!dividir_campos(cabecalho, separador, campos)) throw std::runtime_error("cabeçalho do CSV malformado");
+    std::vector<int> indices(nomes.size(), -1);
+    for (size_t c = 0; c < campos.size(); ++c) {
+        std::string nome;
+        anexar_texto(campos[c], nome);
+        for (size_t k = 0; k < nomes.size(); ++k) {
+            if (nome == nomes[k]) indices[k] = static_cast<int>(c);
+        }
+    }
+    return indices;
+}
+
+// Divide `dados` (linhas inteiras, a primeira sendo a linha `primeira_linha_arquivo` do arquivo)
+// em blocos e conta as linhas de cada um (passada 1). Devolve o total de linhas de dados; cada
+// bloco recebe primeira_linha_tabela, contada a partir de 0. `linhas_fisicas_total`, se não nulo,
+// recebe o número de linhas do texto, vazias incluídas.
+inline size_t dividir_blocos(std::string_view dados, size_t primeira_linha_arquivo, std::vector<Bloco>& blocos,
+                             size_t* linhas_fisicas_total = nullptr) {
+    blocos.clear();
+    const size_t alvo = std::max<size_t>(1, std::min(dados.size() / BYTES_POR_BLOCO + 1,
+                                                     static_cast<size_t>(omp_get_max_threads()) * 8));
+    size_t inicio = 0;
+    for (size_t b = 0; b < alvo && inicio < dados.size(); ++b) {
+        size_t fim = b + 1 == alvo ? dados.size() : std::max(inicio, dados.size() * (b + 1) / alvo);
+        if (fim < dados.size()) {
+            const void* nl = std::memchr(dados.data() + fim, '\n', dados.size() - fim);
+            fim = nl ? static_cast<size_t>(static_cast<const char*>(nl) - dados.data()) + 1 : dados.size();
+        }
+        Bloco bloco;
+        bloco.texto = dados.substr(inicio, fim - inicio);
+        blocos.push_back(bloco);
+        inicio = fim;
+    }
+
+    const int num_blocos = static_cast<int>(blocos.size());
+    std::vector<size_t> linhas_fisicas(num_blocos, 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int b = 0; b < num_blocos; ++b) {
+        size_t p = 0;
+        std::string_view linha;
+        while (proxima_linha(blocos[b].texto, p, linha)) {
+            ++linhas_fisicas[b];
+            if (!aparar(linha).empty()) ++blocos[b].linhas_dados;
+        }
+    }
+
+    size_t linhas = 0, linha_arquivo = primeira_linha_arquivo;
+    for (int b = 0; b < num_blocos; ++b) {
+        blocos[b].primeira_linha_tabela = linhas;
+        blocos[b].primeira_linha_arquivo = linha_arquivo;
+        linhas += blocos[b].linhas_dados;
+        linha_arquivo += linhas_fisicas[b];
+    }
+    if (linhas_fisicas_total != nullptr) *linhas_fisicas_total = linha_arquivo - primeira_linha_arquivo;
+    return linhas;
+}
+
+// Separa o cabeçalho e divide o resto do arquivo em blocos
+inline size_t preparar_blocos(std::string_view texto, std::string_view& cabecalho, std::vector<Bloco>& blocos) {
+    size_t pos = 0;
+    if (!proxima_linha(texto, pos, cabecalho)) throw std::runtime_error("CSV vazio");
+    return dividir_blocos(texto.substr(std::min(pos, texto.size())), 2, blocos);  // a linha 1 é o cabeçalho
+}
+
+// Passada 2: chama converter_linha(campos, linha_tabela, bloco) para cada linha de dados de cada
+// bloco, em paralelo. Uma linha rejeitada marca o bloco e a primeira falha do arquivo é lançada.
+template <typename ConverterLinha>
+void converter_blocos(std::vector<Bloco>& blocos, char separador, const std::string& caminho, ConverterLinha converter_linha) {
+    const int num_blocos = static_cast<int>(blocos.size());
+    #pragma omp parallel
+    {
+        std::vector<std::string_view> campos;
+        #pragma omp for schedule(dynamic, 1)
+        for (int b = 0; b < num_blocos; ++b) {
+            Bloco& bloco = blocos[b];
+            size_t p = 0, linha_arquivo = bloco.primeira_linha_arquivo, linha_tabela = bloco.primeira_linha_tabela;
+            std::string_view linha;
+            for (; proxima_linha(bloco.texto, p, linha); ++linha_arquivo) {
+                if (aparar(linha).empty()) continue;
+                if (!dividir_campos(linha, separador, campos) || !converter_linha(campos, linha_tabela, bloco)) {
+                    bloco.linha_com_erro = linha_arquivo;
+                    break;
+                }
+                ++linha_tabela;
+            }
+        }
+    }
+    for (const Bloco& bloco : blocos) {
+        if (bloco.linha_com_erro != 0) {
+            throw std::runtime_error(caminho + ": linha " + std::to_string(bloco.linha_com_erro) + " malformada");
+        }
+    }
+}
+
+// Passada 2 para uma única coluna numérica, escrita em destino[linha da tabela]
+inline void converter_coluna(std::vector<Bloco>& blocos, char separador, int coluna, double* destino,
+                             const std::string& caminho) {
+    converter_blocos(blocos, separador, caminho,
+                     [&](const std::vector<std::string_view>& campos, size_t i, Bloco&) {
+        return campos.size() > static_cast<size_t>(coluna) && converter(campos[coluna], destino[i]);
+    });
+}
+
+} // namespace detalhe_csv
+
+// Carrega um CSV de funcionários com as colunas salario, departamento, idade e
+// horas_trabalhadas (nome é opcional) numa TabelaFuncionarios
+inline TabelaFuncionarios ler_funcionarios_csv(const std::string& caminho, OpcoesCsv opcoes = {},
+                                               ResumoIngestao* resumo = nullptr) {
+    using namespace detalhe_csv;
+    double inicio = omp_get_wtime();
+    ArquivoMapeado arquivo(caminho);
+
+    std::string_view cabecalho;
+    std::vector<Bloco> blocos;
+    const size_t n = preparar_blocos(arquivo.texto(), cabecalho, blocos);
+
+    enum { NOME, SALARIO, DEPARTAMENTO, IDADE, HORAS };
+    const std::vector<std::string> nomes = {"nome", "salario", "departamento", "idade", "horas_trabalhadas"};
+    const std::vector<int> coluna = localizar_colunas(cabecalho, opcoes.separador, nomes);
+    for (int k = SALARIO; k <= HORAS; ++k) {
+        if (coluna[k] < 0) throw std::runtime_error(caminho + ": coluna " + nomes[k] + " ausente no cabeçalho");
+    }
+    const size_t campos_minimos = static_cast<size_t>(*std::max_element(coluna.begin(), coluna.end())) + 1;
+
+    TabelaFuncionarios tabela;
+    tabela.redimensionar(n);
+    converter_blocos(blocos, opcoes.separador, caminho,
+                     [&](const std::vector<std::string_view>& campos, size_t i, Bloco& bloco) {
+        if (campos.size() < campos_minimos) return false;
+        if (!converter(campos[coluna[SALARIO]], tabela.salario[i]) ||
+            !converter(campos[coluna[DEPARTAMENTO]], tabela.departamento[i]) ||
+            !converter(campos[coluna[IDADE]], tabela.idade[i]) ||
+            !converter(campos[coluna[HORAS]], tabela.horas_trabalhadas[i])) {
+            return false;
+        }
+        if (tabela.departamento[i] < 0 || tabela.departamento[i] > opcoes.maior_departamento) return false;
+        size_t antes = bloco.arena_nomes.size();
+        if (coluna[NOME] >= 0) anexar_texto(campos[coluna[NOME]], bloco.arena_nomes);
+        bloco.tamanho_nome.push_back(bloco.arena_nomes.size() - antes);
+        return true;
+    });
+
+    // Arena de nomes: soma de prefixos dos blocos, depois cada bloco copia e numera os seus
+    const int num_blocos = static_cast<int>(blocos.size());
+    std::vector<size_t> inicio_bloco(num_blocos + 1, 0);
+    for (int b = 0; b < num_blocos; ++b) inicio_bloco[b + 1] = inicio_bloco[b] + blocos[b].arena_nomes.size();
+    tabela.arena_nomes.resize(inicio_bloco[num_blocos]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int b = 0; b < num_blocos; ++b) {
+        const Bloco& bloco = blocos[b];
+        std::copy(bloco.arena_nomes.begin(), bloco.arena_nomes.end(), tabela.arena_nomes.begin() + inicio_bloco[b]);
+        size_t posicao = inicio_bloco[b];
+        for (size_t k = 0; k < bloco.tamanho_nome.size(); ++k) {
+            tabela.inicio_nome[bloco.primeira_linha_tabela + k] = posicao;
+            posicao += bloco.tamanho_nome[k];
+        }
+    }
+    tabela.inicio_nome[n] = tabela.arena_nomes.size();
+
+    if (resumo != nullptr) {
+        resumo->linhas = n;
+        resumo->bytes = arquivo.texto().size();
+        resumo->segundos = omp_get_wtime() - inicio;
+    }
+    return tabela;
+}
+
+// Carrega uma coluna numérica de um CSV (por nome no cabeçalho) num BufferNuma, com as páginas
+// tocadas na divisão estática que as reduções usam depois
+inline BufferNuma<double> ler_coluna_csv(const std::string& caminho, const std::string& nome_coluna,
+                                         OpcoesCsv opcoes = {}, ResumoIngestao* resumo = nullptr) {
+    using namespace detalhe_csv;
+    double inicio = omp_get_wtime();
+    ArquivoMapeado arquivo(caminho);
+
+    std::string_view cabecalho;
+    std::vector<Bloco> blocos;
+    const size_t n = preparar_blocos(arquivo.texto(), cabecalho, blocos);
+    const int coluna = localizar_colunas(cabecalho, opcoes.separador, {nome_coluna})[0];
+    if (coluna < 0) throw std::runtime_error(caminho + ": coluna " + nome_coluna + " ausente no cabeçalho");
+
+    BufferNuma<double> valores;
+    if (n > 0) valores = BufferNuma<double>(n);
+    converter_coluna(blocos, opcoes.separador, coluna, valores.data(), caminho);
+
+    if (resumo != nullptr) {
+        resumo->linhas = n;
+        resumo->bytes = arquivo.texto().size();
+        resumo->segundos = omp_get_wtime() - inicio;
+    }
+    return valores;
+}
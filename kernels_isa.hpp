@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <immintrin.h>
+#include <omp.h>
+
+// Kernels de redução com uma implementação por conjunto de instruções, escolhida uma vez
+// na inicialização por CPUID (__builtin_cpu_supports). O mesmo binário usa AVX-512 onde
+// existe e continua rodando em máquinas só com SSE2.
+//
+// Diferente de target_clones (welford.hpp, centavos.hpp), a escolha fica numa tabela de
+// ponteiros para função: o nível escolhido pode ser consultado (nome) e forçado pela
+// variável de ambiente KERNELS_ISA=generico|avx2|avx512, útil para comparar os níveis.
+//
+// As funções da tabela são seriais; as de fora (soma_isa, minimo_isa, ...) dividem o vetor
+// em blocos de BLOCO_ISA entre as threads e combinam as parciais.
+const size_t BLOCO_ISA = size_t(1) << 16;
+
+struct TabelaKernels {
+    const char* nome;
+    long long (*soma_int)(const int*, size_t);
+    int (*minimo_int)(const int*, size_t);
+    int (*maximo_int)(const int*, size_t);
+    int (*e_int)(const int*, size_t);
+    int (*ou_int)(const int*, size_t);
+    int (*xou_int)(const int*, size_t);
+    long long (*popcount_int)(const int*, size_t);  // total de bits 1
+    double (*soma_double)(const double*, size_t);
+    double (*minimo_double)(const double*, size_t);
+    double (*maximo_double)(const double*, size_t);
+};
+
+namespace detalhe_isa {
+
+// Corpos comuns: sempre inlined na função com atributo target, que define as instruções usadas
+#define KERNEL_ISA_CORPO __attribute__((always_inline)) inline
+
+KERNEL_ISA_CORPO long long soma_int(const int* x, size_t n) {
+    long long s = 0;
+    #pragma omp simd reduction(+:s)
+    for (size_t i = 0; i < n; ++i) s += x[i];
+    return s;
+}
+
+KERNEL_ISA_CORPO int minimo_int(const int* x, size_t n) {
+    int m = std::numeric_limits<int>::max();
+    #pragma omp simd reduction(min:m)
+    for (size_t i = 0; i < n; ++i) m = x[i] < m ? x[i] : m;
+    return m;
+}
+
+KERNEL_ISA_CORPO int maximo_int(const int* x, size_t n) {
+    int m = std::numeric_limits<int>::min();
+    #pragma omp simd reduction(max:m)
+    for (size_t i = 0; i < n; ++i) m = x[i] > m ? x[i] : m;
+    return m;
+}
+
+KERNEL_ISA_CORPO int e_int(const int* x, size_t n) {
+    int r = ~0;
+    #pragma omp simd reduction(&:r)
+    for (size_t i = 0; i < n; ++i) r &= x[i];
+    return r;
+}
+
+KERNEL_ISA_CORPO int ou_int(const int* x, size_t n) {
+    int r = 0;
+    #pragma omp simd reduction(|:r)
+    for (size_t i = 0; i < n; ++i) r |= x[i];
+    return r;
+}
+
+KERNEL_ISA_CORPO int xou_int(const int* x, size_t n) {
+    int r = 0;
+    #pragma omp simd reduction(^:r)
+    for (size_t i = 0; i < n; ++i) r ^= x[i];
+    return r;
+}
+
+KERNEL_ISA_CORPO long long popcount_int(const int* x, size_t n) {
+    long long total = 0;
+    #pragma omp simd reduction(+:total)
+    for (size_t i = 0; i < n; ++i) total += __builtin_popcount(static_cast<unsigned>(x[i]));
+    return total;
+}
+
+// 8 lanes independentes: a associação da soma não depende da largura do vetor
+KERNEL_ISA_CORPO double soma_double(const double* x, size_t n) {
+    double lanes[8] = {};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        #pragma omp simd
+        for (int l = 0; l < 8; ++l) lanes[l] += x[i + l];
+    }
+    for (; i < n; ++i) lanes[i % 8] += x[i];
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+KERNEL_ISA_CORPO double minimo_double(const double* x, size_t n) {
+    double m = std::numeric_limits<double>::max();
+    #pragma omp simd reduction(min:m)
+    for (size_t i = 0; i < n; ++i) m = x[i] < m ? x[i] : m;
+    return m;
+}
+
+KERNEL_ISA_CORPO double maximo_double(const double* x, size_t n) {
+    double m = std::numeric_limits<double>::lowest();
+    #pragma omp simd reduction(max:m)
+    for (size_t i = 0; i < n; ++i) m = x[i] > m ? x[i] : m;
+    return m;
+}
+
+// Instancia todos os corpos com um atributo target, no namespace NS
+#define KERNELS_ISA_INSTANCIAR(NS, ALVO)                                                              \
+    namespace NS {                                                                                    \
+    ALVO long long soma_int(const int* x, size_t n) { return detalhe_isa::soma_int(x, n); }          \
+    ALVO int minimo_int(const int* x, size_t n) { return detalhe_isa::minimo_int(x, n); }            \
+    ALVO int maximo_int(const int* x, size_t n) { return detalhe_isa::maximo_int(x, n); }            \
+    ALVO int e_int(const int* x, size_t n) { return detalhe_isa::e_int(x, n); }                      \
+    ALVO int ou_int(const int* x, size_t n) { return detalhe_isa::ou_int(x, n); }                    \
+    ALVO int xou_int(const int* x, size_t n) { return detalhe_isa::xou_int(x, n); }                  \
+    ALVO long long popcount_int(const int* x, size_t n) { return detalhe_isa::popcount_int(x, n); }  \
+    ALVO double soma_double(const double* x, size_t n) { return detalhe_isa::soma_double(x, n); }    \
+    ALVO double minimo_double(const double* x, size_t n) { return detalhe_isa::minimo_double(x, n); }\
+    ALVO double maximo_double(const double* x, size_t n) { return detalhe_isa::maximo_double(x, n); }\
+    }
+
+KERNELS_ISA_INSTANCIAR(generico, inline)
+KERNELS_ISA_INSTANCIAR(avx2, __attribute__((target("avx2,popcnt"))) inline)
+KERNELS_ISA_INSTANCIAR(avx512, __attribute__((target("avx512f,avx512bw,avx512vl,popcnt"))) inline)
+
+#undef KERNELS_ISA_INSTANCIAR
+#undef KERNEL_ISA_CORPO
+
+// AVX2 não tem popcount vetorial: contagem por nibble com tabela em vpshufb, somada em
+// bytes e reduzida com vpsadbw a cada 31 iterações (antes de um byte estourar)
+__attribute__((target("avx2"))) inline long long popcount_int_avx2(const int* x, size_t n) {
+    const __m256i tabela = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 8 <= n) {
+        __m256i bytes = _mm256_setzero_si256();
+        for (int passo = 0; passo < 31 && i + 8 <= n; ++passo, i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            __m256i baixo = _mm256_shuffle_epi8(tabela, _mm256_and_si256(v, nibble));
+            __m256i alto = _mm256_shuffle_epi8(tabela, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(baixo, alto));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    long long s = _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                  _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+    for (; i < n; ++i) s += __builtin_popcount(static_cast<unsigned>(x[i]));
+    return s;
+}
+
+// AVX-512 VPOPCNTDQ: popcount de 16 inteiros por instrução. Cada lane de 32 bits soma no
+// máximo 32 por iteração, então as lanes são descarregadas em 64 bits a cada 2^20 iterações.
+__attribute__((target("avx512f,avx512vpopcntdq"))) inline long long popcount_int_avx512(const int* x, size_t n) {
+    long long s = 0;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m512i total = _mm512_setzero_si512();
+        for (size_t passo = 0; passo < (size_t(1) << 20) && i + 16 <= n; ++passo, i += 16) {
+            total = _mm512_add_epi32(total, _mm512_popcnt_epi32(_mm512_loadu_si512(x + i)));
+        }
+        alignas(64) uint32_t lanes[16];
+        _mm512_store_si512(lanes, total);
+        for (uint32_t lane : lanes) s += lane;
+    }
+    for (; i < n; ++i) s += __builtin_popcount(static_cast<unsigned>(x[i]));
+    return s;
+}
+
+#define KERNELS_ISA_TABELA(NS, NOME)                                                          \
+    TabelaKernels{NOME, NS::soma_int, NS::minimo_int, NS::maximo_int, NS::e_int, NS::ou_int, \
+                  NS::xou_int, NS::popcount_int, NS::soma_double, NS::minimo_double, NS::maximo_double}
+
+inline TabelaKernels escolher_kernels() {
+    __builtin_cpu_init();
+    const bool tem_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    const bool tem_avx512 = tem_avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                            __builtin_cpu_supports("avx512vl");
+
+    const char* forcado = std::getenv("KERNELS_ISA");
+    bool usar_avx512 = tem_avx512, usar_avx2 = tem_avx2;
+    if (forcado != nullptr) {
+        usar_avx512 = tem_avx512 && std::strcmp(forcado, "avx512") == 0;
+        usar_avx2 = tem_avx2 && (usar_avx512 || std::strcmp(forcado, "avx2") == 0);
+    }
+
+    if (usar_avx512) {
+        TabelaKernels t = KERNELS_ISA_TABELA(avx512, "avx512");
+        t.popcount_int = __builtin_cpu_supports("avx512vpopcntdq") ? popcount_int_avx512 : popcount_int_avx2;
+        return t;
+    }
+    if (usar_avx2) {
+        TabelaKernels t = KERNELS_ISA_TABELA(avx2, "avx2");
+        t.popcount_int = popcount_int_avx2;
+        return t;
+    }
+    return KERNELS_ISA_TABELA(generico, "generico");
+}
+
+#undef KERNELS_ISA_TABELA
+
+} // namespace detalhe_isa
+
+// Tabela escolhida na primeira chamada (inicialização estática local, segura entre threads)
+inline const TabelaKernels& kernels_isa() {
+    static const TabelaKernels tabela = detalhe_isa::escolher_kernels();
+    return tabela;
+}
+
+// Versões paralelas: blocos de BLOCO_ISA por iteração, parciais combinadas pela reduction
+// do operador correspondente
+inline long long soma_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    long long s = 0;
+    #pragma omp parallel for schedule(static) reduction(+:s)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) s += k.soma_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return s;
+}
+
+inline double soma_isa(const double* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    double s = 0.0;
+    #pragma omp parallel for schedule(static) reduction(+:s)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) s += k.soma_double(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return s;
+}
+
+inline int minimo_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    int m = std::numeric_limits<int>::max();
+    #pragma omp parallel for schedule(static) reduction(min:m)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) {
+        int parcial = k.minimo_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+        m = parcial < m ? parcial : m;
+    }
+    return m;
+}
+
+inline double minimo_isa(const double* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    double m = std::numeric_limits<double>::max();
+    #pragma omp parallel for schedule(static) reduction(min:m)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) {
+        double parcial = k.minimo_double(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+        m = parcial < m ? parcial : m;
+    }
+    return m;
+}
+
+inline int maximo_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    int m = std::numeric_limits<int>::min();
+    #pragma omp parallel for schedule(static) reduction(max:m)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) {
+        int parcial = k.maximo_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+        m = parcial > m ? parcial : m;
+    }
+    return m;
+}
+
+inline double maximo_isa(const double* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    double m = std::numeric_limits<double>::lowest();
+    #pragma omp parallel for schedule(static) reduction(max:m)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) {
+        double parcial = k.maximo_double(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+        m = parcial > m ? parcial : m;
+    }
+    return m;
+}
+
+inline int e_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    int r = ~0;
+    #pragma omp parallel for schedule(static) reduction(&:r)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) r &= k.e_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return r;
+}
+
+inline int ou_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    int r = 0;
+    #pragma omp parallel for schedule(static) reduction(|:r)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) r |= k.ou_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return r;
+}
+
+inline int xou_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    int r = 0;
+    #pragma omp parallel for schedule(static) reduction(^:r)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) r ^= k.xou_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return r;
+}
+
+inline long long popcount_isa(const int* x, size_t n) {
+    const TabelaKernels& k = kernels_isa();
+    long long total = 0;
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (size_t i = 0; i < n; i += BLOCO_ISA) total += k.popcount_int(x + i, n - i < BLOCO_ISA ? n - i : BLOCO_ISA);
+    return total;
+}
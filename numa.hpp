@@ -0,0 +1,262 @@
+#pragma once
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+// Memória consciente de NUMA para os vetores de dados.
+//
+// O Linux põe cada página no nó NUMA da thread que a toca primeiro. Um std::vector<double>(N)
+// é zerado pela thread principal, então todas as páginas caem num só nó e, em máquinas com
+// dois soquetes, as reduções param na banda de um soquete. BufferNuma<T>:
+//   - reserva com mmap, sem inicializar (nenhuma página é tocada na alocação);
+//   - faz o primeiro toque em paralelo com a mesma divisão de schedule(static) das reduções,
+//     então cada thread lê depois as páginas que estão no seu nó;
+//   - pede huge pages (madvise MADV_HUGEPAGE) com BUFFER_NUMA_HUGEPAGES=1. O início do
+//     buffer fica alinhado em 2 MB, para que o kernel consiga usar huge pages nele inteiro, e
+//     o primeiro toque passa a ser por huge page: cada página de 2 MB vai para o nó da thread
+//     cuja faixa contém o início dela. A posse das páginas vale então com granularidade de
+//     2 MB, e uma página na fronteira entre duas faixas fica inteira com uma das threads.
+//
+// A fixação das threads fica em fixar_threads(), configurável por AFINIDADE_THREADS.
+
+namespace detalhe_numa {
+
+const size_t TAMANHO_HUGEPAGE = size_t(2) << 20;
+
+inline bool usar_hugepages() {
+    const char* valor = std::getenv("BUFFER_NUMA_HUGEPAGES");
+    return valor != nullptr && std::strcmp(valor, "0") != 0;
+}
+
+// Faixa [inicio, fim) da thread t entre nt em schedule(static) sem chunk: blocos contíguos,
+// os n % nt primeiros com um elemento a mais (a divisão usada pelo libgomp e pelo libomp)
+inline void faixa_estatica(size_t n, int t, int nt, size_t& inicio, size_t& fim) {
+    const size_t q = n / nt, r = n % nt;
+    const size_t tt = static_cast<size_t>(t);
+    inicio = tt * q + (tt < r ? tt : r);
+    fim = inicio + q + (tt < r ? 1 : 0);
+}
+
+} // namespace detalhe_numa
+
+template <typename T>
+class BufferNuma {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "BufferNuma guarda tipos triviais (colunas numéricas)");
+
+public:
+    BufferNuma() = default;
+
+    // Alocação com primeiro toque paralelo (conteúdo zerado pelo kernel)
+    explicit BufferNuma(size_t n) {
+        alocar(n);
+        tocar_paginas();
+    }
+
+    // Alocação preenchida por valor(i) num laço schedule(static): o preenchimento é o primeiro toque
+    // (com huge pages, as páginas são tocadas antes para que a posse siga a regra de tocar_paginas)
+    template <typename Gerador>
+    BufferNuma(size_t n, Gerador valor) {
+        alocar(n);
+        if (pagina_ == detalhe_numa::TAMANHO_HUGEPAGE) tocar_paginas();
+        T* d = dados_;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            d[i] = valor(i);
+        }
+    }
+
+    BufferNuma(const BufferNuma&) = delete;
+    BufferNuma& operator=(const BufferNuma&) = delete;
+
+    BufferNuma(BufferNuma&& outro) noexcept { trocar(outro); }
+    BufferNuma& operator=(BufferNuma&& outro) noexcept {
+        if (this != &outro) {
+            liberar();
+            trocar(outro);
+        }
+        return *this;
+    }
+
+    ~BufferNuma() { liberar(); }
+
+    T* data() { return dados_; }
+    const T* data() const { return dados_; }
+    size_t size() const { return tamanho_; }
+    bool empty() const { return tamanho_ == 0; }
+    T& operator[](size_t i) { return dados_[i]; }
+    const T& operator[](size_t i) const { return dados_[i]; }
+    T* begin() { return dados_; }
+    T* end() { return dados_ + tamanho_; }
+    const T* begin() const { return dados_; }
+    const T* end() const { return dados_ + tamanho_; }
+
+private:
+    T* dados_ = nullptr;
+    size_t tamanho_ = 0;
+    size_t bytes_ = 0;
+    size_t pagina_ = 0;  // granularidade do primeiro toque: página normal ou huge page
+
+    void alocar(size_t n) {
+        tamanho_ = n;
+        if (n == 0) return;
+        const bool huge = detalhe_numa::usar_hugepages();
+        pagina_ = huge ? detalhe_numa::TAMANHO_HUGEPAGE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        bytes_ = (n * sizeof(T) + pagina_ - 1) / pagina_ * pagina_;
+
+        // Com huge pages, reserva 2 MB a mais e devolve a sobra antes e depois do trecho alinhado
+        const size_t reserva = huge ? bytes_ + pagina_ : bytes_;
+        void* p = mmap(nullptr, reserva, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        char* inicio = static_cast<char*>(p);
+        if (huge) {
+            const uintptr_t endereco = reinterpret_cast<uintptr_t>(p);
+            char* alinhado = inicio + ((pagina_ - endereco % pagina_) % pagina_);
+            if (alinhado > inicio) munmap(inicio, alinhado - inicio);
+            if (inicio + reserva > alinhado + bytes_) munmap(alinhado + bytes_, inicio + reserva - (alinhado + bytes_));
+            inicio = alinhado;
+#ifdef MADV_HUGEPAGE
+            madvise(inicio, bytes_, MADV_HUGEPAGE);
+#endif
+        }
+        dados_ = reinterpret_cast<T*>(inicio);
+    }
+
+    // Cada thread escreve um byte em cada página (ou huge page) cujo início cai na sua faixa estática
+    void tocar_paginas() {
+        const size_t pagina = pagina_;
+        char* base = reinterpret_cast<char*>(dados_);
+        const size_t n = tamanho_;
+        #pragma omp parallel
+        {
+            size_t inicio, fim;
+            detalhe_numa::faixa_estatica(n, omp_get_thread_num(), omp_get_num_threads(), inicio, fim);
+            size_t byte = (inicio * sizeof(T) + pagina - 1) / pagina * pagina;
+            for (; byte < fim * sizeof(T); byte += pagina) {
+                base[byte] = 0;
+            }
+        }
+    }
+
+    void liberar() {
+        if (dados_ != nullptr) munmap(dados_, bytes_);
+        dados_ = nullptr;
+        tamanho_ = 0;
+        bytes_ = 0;
+    }
+
+    void trocar(BufferNuma& outro) {
+        std::swap(dados_, outro.dados_);
+        std::swap(tamanho_, outro.tamanho_);
+        std::swap(bytes_, outro.bytes_);
+        std::swap(pagina_, outro.pagina_);
+    }
+};
+
+// CPUs de cada nó NUMA, lidas de /sys (um nó só, com as CPUs permitidas, se não houver /sys)
+inline std::vector<std::vector<int>> cpus_por_no() {
+    cpu_set_t permitidas;
+    CPU_ZERO(&permitidas);
+    sched_getaffinity(0, sizeof(permitidas), &permitidas);
+
+    std::vector<std::vector<int>> nos;
+    for (int no = 0;; ++no) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(no) + "/cpulist");
+        if (!in) break;
+        std::string lista;
+        std::getline(in, lista);
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < lista.size()) {
+            size_t virgula = lista.find(',', pos);
+            std::string faixa = lista.substr(pos, virgula == std::string::npos ? std::string::npos : virgula - pos);
+            size_t traco = faixa.find('-');
+            int a = std::atoi(faixa.c_str());
+            int b = traco == std::string::npos ? a : std::atoi(faixa.c_str() + traco + 1);
+            for (int c = a; c <= b; ++c) {
+                if (c < CPU_SETSIZE && CPU_ISSET(c, &permitidas)) cpus.push_back(c);
+            }
+            if (virgula == std::string::npos) break;
+            pos = virgula + 1;
+        }
+        if (!cpus.empty()) nos.push_back(cpus);
+    }
+
+    if (nos.empty()) {
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &permitidas)) cpus.push_back(c);
+        }
+        nos.push_back(cpus);
+    }
+    return nos;
+}
+
+enum class PoliticaAfinidade { NENHUMA, COMPACTA, ESPALHADA };
+
+// AFINIDADE_THREADS=compacta|espalhada|nenhuma (padrão: nenhuma, respeitando OMP_PROC_BIND)
+inline PoliticaAfinidade politica_do_ambiente() {
+    const char* valor = std::getenv("AFINIDADE_THREADS");
+    if (valor == nullptr) return PoliticaAfinidade::NENHUMA;
+    if (std::strcmp(valor, "compacta") == 0) return PoliticaAfinidade::COMPACTA;
+    if (std::strcmp(valor, "espalhada") == 0) return PoliticaAfinidade::ESPALHADA;
+    return PoliticaAfinidade::NENHUMA;
+}
+
+inline const char* nome_politica(PoliticaAfinidade p) {
+    switch (p) {
+        case PoliticaAfinidade::COMPACTA: return "compacta";
+        case PoliticaAfinidade::ESPALHADA: return "espalhada";
+        default: return "nenhuma";
+    }
+}
+
+// Fixa cada thread da equipe de `threads` threads numa CPU:
+//   compacta  - enche um nó antes de passar ao próximo (mede a banda de um soquete)
+//   espalhada - alterna entre os nós (usa a banda de todos os soquetes desde poucas threads)
+// OMP_PROC_BIND é lido quando o runtime carrega, antes de main; esta função permite trocar
+// a política durante a execução. O runtime reaproveita as threads do pool, então a fixação
+// vale para as próximas regiões com o mesmo número de threads.
+inline void fixar_threads(PoliticaAfinidade politica, int threads = omp_get_max_threads()) {
+    if (politica == PoliticaAfinidade::NENHUMA) return;
+    // Lido uma vez: depois da primeira fixação a thread principal só enxerga a própria CPU
+    static const std::vector<std::vector<int>> nos = cpus_por_no();
+
+    std::vector<int> ordem;
+    if (politica == PoliticaAfinidade::COMPACTA) {
+        for (const auto& cpus : nos) ordem.insert(ordem.end(), cpus.begin(), cpus.end());
+    } else {
+        for (size_t k = 0;; ++k) {
+            bool alguma = false;
+            for (const auto& cpus : nos) {
+                if (k < cpus.size()) {
+                    ordem.push_back(cpus[k]);
+                    alguma = true;
+                }
+            }
+            if (!alguma) break;
+        }
+    }
+    if (ordem.empty()) return;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(ordem[omp_get_thread_num() % ordem.size()], &conjunto);
+        sched_setaffinity(0, sizeof(conjunto), &conjunto);
+    }
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "numa.hpp"
+#include "quantis.hpp"
+
+// Ordenação radix LSD paralela para doubles, e uma coluna ordenada reaproveitável para
+// consultas de rank, percentil e ECDF em O(log n).
+//
+// Chave: os bits IEEE de cada double viram um uint64 cuja ordem sem sinal é a ordem numérica
+// (positivos ganham o bit de sinal; negativos têm todos os bits invertidos). -0.0 fica antes de
+// +0.0, e NaNs ficam nas pontas (com sinal antes de -inf, sem sinal depois de +inf).
+//
+// A chave é ordenada em 6 passadas de 11 bits (histogramas de 2048 contadores, que cabem na
+// L1). Cada passada: histograma privado por thread sobre a faixa estática, soma de prefixos
+// dígito a dígito e, dentro do dígito, thread a thread, e espalhamento estável de cada faixa
+// na sua posição, o mesmo esquema do espalhamento por baldes de SeletorQuantis. Um histograma
+// global de todos os dígitos, feito numa única leitura inicial, pula as passadas em que todas
+// as chaves têm o mesmo dígito (sinal e expoente iguais, comum em salários).
+
+namespace detalhe_radix {
+
+const int BITS_DIGITO = 11;
+const int NUM_DIGITOS = 1 << BITS_DIGITO;
+const int PASSADAS = (64 + BITS_DIGITO - 1) / BITS_DIGITO;
+const size_t LIMIAR_PARALELO = 1 << 16;
+
+inline uint64_t chave(double x) {
+    uint64_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return (b >> 63) ? ~b : (b | (uint64_t(1) << 63));
+}
+
+inline double valor(uint64_t k) {
+    uint64_t b = (k >> 63) ? (k & ~(uint64_t(1) << 63)) : ~k;
+    double x;
+    std::memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+inline unsigned digito(uint64_t k, int passada) {
+    return static_cast<unsigned>(k >> (passada * BITS_DIGITO)) & (NUM_DIGITOS - 1);
+}
+
+} // namespace detalhe_radix
+
+// Grava em saida[0..n) os valores de entrada[0..n) ordenados (saida pode ser a própria entrada).
+// Com `permutacao`, permutacao[i] é a posição em `entrada` do valor que terminou em saida[i]
+// (ordenação estável: empates mantêm a ordem original).
+inline void ordenar_radix(const double* entrada, size_t n, double* saida, size_t* permutacao = nullptr) {
+    using namespace detalhe_radix;
+    if (n == 0) return;
+    const bool paralelo = n > LIMIAR_PARALELO;
+    const int maxThreads = paralelo ? omp_get_max_threads() : 1;
+
+    BufferNuma<uint64_t> origem(n, [entrada](size_t i) { return chave(entrada[i]); });
+    BufferNuma<uint64_t> destino(n);
+    BufferNuma<size_t> indice_origem, indice_destino;
+    if (permutacao != nullptr) {
+        indice_origem = BufferNuma<size_t>(n, [](size_t i) { return i; });
+        indice_destino = BufferNuma<size_t>(n);
+    }
+
+    // Histograma global de todos os dígitos: decide quais passadas são necessárias
+    std::vector<size_t> global(static_cast<size_t>(PASSADAS) * NUM_DIGITOS, 0);
+    #pragma omp parallel num_threads(maxThreads) if(paralelo)
+    {
+        std::vector<size_t> local(static_cast<size_t>(PASSADAS) * NUM_DIGITOS, 0);
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t k = origem[i];
+            for (int p = 0; p < PASSADAS; ++p) local[static_cast<size_t>(p) * NUM_DIGITOS + digito(k, p)]++;
+        }
+        #pragma omp critical
+        for (size_t j = 0; j < local.size(); ++j) global[j] += local[j];
+    }
+
+    std::vector<size_t> contagens(static_cast<size_t>(maxThreads) * NUM_DIGITOS);
+    for (int p = 0; p < PASSADAS; ++p) {
+        const size_t* h = &global[static_cast<size_t>(p) * NUM_DIGITOS];
+        if (std::find(h, h + NUM_DIGITOS, n) != h + NUM_DIGITOS) continue;  // dígito constante
+
+        const uint64_t* chaves = origem.data();
+        uint64_t* chaves_saida = destino.data();
+        const size_t* indices = indice_origem.data();
+        size_t* indices_saida = indice_destino.data();
+
+        #pragma omp parallel num_threads(maxThreads) if(paralelo)
+        {
+            const int t = omp_get_thread_num();
+            const int nt = omp_get_num_threads();
+            size_t ini, fim;
+            detalhe_numa::faixa_estatica(n, t, nt, ini, fim);
+            size_t* minhas = &contagens[static_cast<size_t>(t) * NUM_DIGITOS];
+
+            std::fill(minhas, minhas + NUM_DIGITOS, 0);
+            for (size_t i = ini; i < fim; ++i) minhas[digito(chaves[i], p)]++;
+
+            #pragma omp barrier
+
+            // Deslocamentos: dígitos em ordem, threads em ordem dentro de cada dígito
+            #pragma omp single
+            {
+                size_t deslocamento = 0;
+                for (int d = 0; d < NUM_DIGITOS; ++d) {
+                    for (int th = 0; th < nt; ++th) {
+                        size_t& c = contagens[static_cast<size_t>(th) * NUM_DIGITOS + d];
+                        size_t total = c;
+                        c = deslocamento;
+                        deslocamento += total;
+                    }
+                }
+            }
+
+            if (indices != nullptr) {
+                for (size_t i = ini; i < fim; ++i) {
+                    const size_t pos = minhas[digito(chaves[i], p)]++;
+                    chaves_saida[pos] = chaves[i];
+                    indices_saida[pos] = indices[i];
+                }
+            } else {
+                for (size_t i = ini; i < fim; ++i) chaves_saida[minhas[digito(chaves[i], p)]++] = chaves[i];
+            }
+        }
+        std::swap(origem, destino);
+        std::swap(indice_origem, indice_destino);
+    }
+
+    const uint64_t* chaves = origem.data();
+    const size_t* indices = indice_origem.data();
+    #pragma omp parallel for schedule(static) if(paralelo)
+    for (size_t i = 0; i < n; ++i) {
+        saida[i] = valor(chaves[i]);
+        if (permutacao != nullptr) permutacao[i] = indices[i];
+    }
+}
+
+// Ordena dados[0..n) no lugar
+inline void ordenar_radix(double* dados, size_t n, size_t* permutacao = nullptr) {
+    ordenar_radix(dados, n, dados, permutacao);
+}
+
+// Cópia ordenada de uma coluna, guardada para consultas repetidas sem reordenar.
+// Com a permutação, linha_original(i) diz de qual linha da coluna veio o i-ésimo menor valor.
+class ColunaOrdenada {
+public:
+    ColunaOrdenada() = default;
+
+    ColunaOrdenada(const double* x, size_t n, bool comPermutacao = false)
+        : valores_(n) {
+        if (comPermutacao) permutacao_ = BufferNuma<size_t>(n);
+        ordenar_radix(x, n, valores_.data(), comPermutacao ? permutacao_.data() : nullptr);
+    }
+
+    size_t size() const { return valores_.size(); }
+    const double* valores() const { return valores_.data(); }
+    double operator[](size_t i) const { return valores_[i]; }
+
+    bool tem_permutacao() const { return !permutacao_.empty(); }
+    size_t linha_original(size_t posicao) const { return permutacao_[posicao]; }
+
+    // Quantidade de valores <= x
+    size_t rank(double x) const { return std::upper_bound(valores_.begin(), valores_.end(), x) - valores_.begin(); }
+
+    // Quantidade de valores em [a, b]
+    size_t contar_entre(double a, double b) const {
+        if (b < a) return 0;
+        return rank(b) - (std::lower_bound(valores_.begin(), valores_.end(), a) - valores_.begin());
+    }
+
+    // F(x) = P(X <= x) e a mesma fração em percentil ("este salário está no percentil 73")
+    double ecdf(double x) const { return valores_.empty() ? 0.0 : static_cast<double>(rank(x)) / size(); }
+    double percentil_de(double x) const { return 100.0 * ecdf(x); }
+
+    // Quantil exato em O(1), com a convenção de posicao_quantil
+    double quantil(double q) const { return valores_[posicao_quantil(q, size())]; }
+
+    // ECDF completa em até `max_pontos` degraus (valor, F(valor)), espaçados por posição;
+    // max_pontos = 0 devolve todos os valores distintos
+    std::vector<std::pair<double, double>> pontos_ecdf(size_t max_pontos = 0) const {
+        std::vector<std::pair<double, double>> pontos;
+        const size_t n = size();
+        if (n == 0) return pontos;
+        const size_t passo = max_pontos == 0 ? 1 : std::max<size_t>(1, n / max_pontos);
+        size_t i = passo - 1;
+        while (i < n) {
+            // Fim da sequência de empates, para que F(valor) conte todos os iguais
+            const double v = valores_[i];
+            const size_t fim = std::upper_bound(valores_.begin() + i, valores_.end(), v) - valores_.begin();
+            pontos.emplace_back(v, static_cast<double>(fim) / n);
+            i = std::max(i + passo, fim);
+        }
+        if (pontos.empty() || pontos.back().second < 1.0) pontos.emplace_back(valores_[n - 1], 1.0);
+        return pontos;
+    }
+
+private:
+    BufferNuma<double> valores_;
+    BufferNuma<size_t> permutacao_;
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Gerador baseado em contador Philox4x32-10 (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3"). O valor de cada elemento depende apenas de (semente, índice):
+// não há estado compartilhado entre threads e qualquer execução pode ser repetida
+// a partir da semente, com qualquer número de threads.
+
+struct Philox4x32 {
+    uint32_t v[4];
+};
+
+inline Philox4x32 philox4x32(uint64_t contador, uint64_t semente) {
+    const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+    const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+    uint32_t c0 = static_cast<uint32_t>(contador);
+    uint32_t c1 = static_cast<uint32_t>(contador >> 32);
+    uint32_t c2 = 0, c3 = 0;
+    uint32_t k0 = static_cast<uint32_t>(semente);
+    uint32_t k1 = static_cast<uint32_t>(semente >> 32);
+
+    for (int rodada = 0; rodada < 10; ++rodada) {
+        uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += W0;
+        k1 += W1;
+    }
+    return {{c0, c1, c2, c3}};
+}
+
+// Converte 64 bits aleatórios em um double uniforme em (0, 1] (53 bits de mantissa).
+// O intervalo aberto em 0 permite usar o valor direto em log() no Box-Muller.
+// Os 53 bits são convertidos em duas metades por int32 -> double (exato; uint64 -> double
+// só vetoriza com AVX-512DQ): k = alto21·2^32 + baixo32, com o uint32 deslocado para int32.
+inline double philox_para_unitario(uint32_t alto, uint32_t baixo) {
+    const uint32_t parte_alta = alto >> 11;
+    const uint32_t parte_baixa = (alto << 21) | (baixo >> 11);
+    const double k = static_cast<double>(static_cast<int32_t>(parte_alta)) * 4294967296.0 +
+                     (static_cast<double>(static_cast<int32_t>(parte_baixa ^ 0x80000000u)) + 2147483648.0);
+    return (k + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+// Uniforme em [a, b) para o elemento de índice i
+inline double philox_uniforme(uint64_t semente, uint64_t i, double a, double b) {
+    Philox4x32 r = philox4x32(i, semente);
+    return a + (b - a) * (philox_para_unitario(r.v[0], r.v[1]) - 0x1p-53);
+}
+
+// Preenche saida[0..n) com uniformes em [a, b): saida[i] depende apenas de (semente, i)
+inline void preencher_uniforme(double* saida, size_t n, uint64_t semente, double a, double b) {
+    #pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        saida[i] = philox_uniforme(semente, i, a, b);
+    }
+}
+
+namespace detalhe_philox {
+
+// log, seno, cosseno e raiz sem desvios nem chamadas à libm, para vetorizar sob omp simd (a
+// libm é escalar sem -ffast-math, e o sqrt com errno vira desvio). Os polinômios são os da
+// fdlibm; erro de ~1 ulp no domínio usado pelo Box-Muller, que é tudo o que se pede deles.
+// Levam os mesmos atributos de box_muller_bloco, para que sejam expandidas dentro dele.
+
+// log(u) para u em (0, 1] normal: u = m·2^e com m em [√2/2, √2), log(1 + f) = 2·atanh(f/(2 + f))
+__attribute__((optimize("fp-contract=off", "no-trapping-math")))
+inline double log_unitario(double u) {
+    const double LN2_ALTO = 6.93147180369123816490e-01, LN2_BAIXO = 1.90821492927058770002e-10;
+    const double LG1 = 6.666666666666735130e-01, LG2 = 3.999999999940941908e-01;
+    const double LG3 = 2.857142874366239149e-01, LG4 = 2.222219843214978396e-01;
+    const double LG5 = 1.818357216161805012e-01, LG6 = 1.531383769920937332e-01;
+    const double LG7 = 1.479819860511658591e-01;
+
+    // Expoente por int32 -> double (int64 -> double só vetoriza com AVX-512DQ)
+    uint64_t bits;
+    std::memcpy(&bits, &u, sizeof(bits));
+    double k = static_cast<double>(static_cast<int32_t>(bits >> 52)) - 1023.0;
+    bits = (bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;  // mantissa em [1, 2)
+    double m;
+    std::memcpy(&m, &bits, sizeof(m));
+    const bool acima = m > 1.4142135623730951;
+    m = acima ? 0.5 * m : m;
+    k = acima ? k + 1.0 : k;
+
+    const double f = m - 1.0;
+    const double s = f / (2.0 + f);
+    const double z = s * s;
+    const double w = z * z;
+    const double r = z * (LG1 + w * (LG3 + w * (LG5 + w * LG7))) + w * (LG2 + w * (LG4 + w * LG6));
+    const double meio_f2 = 0.5 * f * f;
+    return k * LN2_ALTO - ((meio_f2 - (s * (meio_f2 + r) + k * LN2_BAIXO)) - f);
+}
+
+// sen(2π·v) e cos(2π·v): a redução é feita em voltas (exata), até um quadrante de [-π/4, π/4]
+__attribute__((optimize("fp-contract=off", "no-trapping-math")))
+inline void sincos_voltas(double v, double& seno, double& cosseno) {
+    const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03;
+    const double S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06;
+    const double S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+    const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03;
+    const double C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07;
+    const double C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+    const double DOIS_PI = 6.283185307179586476925286766559;
+
+    // v = k/4 + r com |r| <= 1/8: quadrante k (mod 4) e ângulo 2π·r em [-π/4, π/4]
+    const double ARREDONDA = 6755399441055744.0;  // 1,5·2^52: soma e subtração arredondam ao inteiro
+    const double quartos = (4.0 * v + ARREDONDA) - ARREDONDA;
+    const double x = DOIS_PI * (v - 0.25 * quartos);
+    const int quadrante = static_cast<int>(quartos) & 3;
+
+    const double z = x * x;
+    const double sen = x + x * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    const double meio_z = 0.5 * z;
+    const double um_menos = 1.0 - meio_z;
+    const double cos = um_menos + (((1.0 - um_menos) - meio_z) +
+                                   z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6))))));
+
+    // Rotação pelo quadrante: 1 -> (cos, -sen), 2 -> (-sen, -cos), 3 -> (-cos, sen)
+    const bool troca = quadrante & 1;
+    const double a = troca ? cos : sen;
+    const double b = troca ? sen : cos;
+    seno = (quadrante >= 2) ? -a : a;
+    cosseno = (quadrante == 1 || quadrante == 2) ? -b : b;
+}
+
+// √x para x >= 0 finito: estimativa de 1/√x pelos bits, 4 passos de Newton (erro relativo
+// 3·10^-2 -> ~10^-21) e uma correção final de √x = x/√x. x = 0 dá 0.
+__attribute__((optimize("fp-contract=off", "no-trapping-math")))
+inline double raiz(double x) {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5FE6EB50C7B537A9ull - (bits >> 1);
+    double y;
+    std::memcpy(&y, &bits, sizeof(y));
+    const double meio_x = 0.5 * x;
+    y = y * (1.5 - meio_x * y * y);
+    y = y * (1.5 - meio_x * y * y);
+    y = y * (1.5 - meio_x * y * y);
+    y = y * (1.5 - meio_x * y * y);
+    const double r = x * y;
+    return r + 0.5 * y * (x - r * r);
+}
+
+// Box-Muller de um bloco de pares uniformes: cos em normal1 e sen em normal2.
+// target_clones como welford_bloco; fp-contract=off mantém os mesmos bits em qualquer CPU e
+// no-trapping-math deixa os ternários de log_unitario e sincos_voltas virarem blends no SSE2/AVX2.
+__attribute__((target_clones("avx512f", "avx2", "default"), optimize("fp-contract=off", "no-trapping-math")))
+inline void box_muller_bloco(const double* u1, const double* u2, size_t n, double media, double desvio,
+                             double* normal1, double* normal2) {
+    #pragma omp simd
+    for (size_t j = 0; j < n; ++j) {
+        double seno, cosseno;
+        sincos_voltas(u2[j], seno, cosseno);
+        const double raio = raiz(-2.0 * log_unitario(u1[j]));
+        normal1[j] = media + desvio * raio * cosseno;
+        normal2[j] = media + desvio * raio * seno;
+    }
+}
+
+} // namespace detalhe_philox
+
+// Preenche saida[0..n) com normais N(media, desvio) via Box-Muller.
+// Cada contador gera dois uniformes e portanto um par de normais: os elementos 2p e 2p+1
+// vêm do contador p. As rodadas Philox são geradas por bloco em um laço SIMD, e o
+// Box-Muller roda em box_muller_bloco, com o log e o seno/cosseno polinomiais de detalhe_philox.
+inline void preencher_normal(double* saida, size_t n, uint64_t semente, double media, double desvio) {
+    const size_t BLOCO = 256; // pares por bloco
+    const size_t numPares = (n + 1) / 2;
+    const size_t numBlocos = (numPares + BLOCO - 1) / BLOCO;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t bloco = 0; bloco < numBlocos; ++bloco) {
+        double u1[BLOCO], u2[BLOCO];
+        const size_t inicio = bloco * BLOCO;
+        const size_t tamanho = (numPares - inicio < BLOCO) ? numPares - inicio : BLOCO;
+
+        #pragma omp simd
+        for (size_t j = 0; j < tamanho; ++j) {
+            Philox4x32 r = philox4x32(inicio + j, semente);
+            u1[j] = philox_para_unitario(r.v[0], r.v[1]);
+            u2[j] = philox_para_unitario(r.v[2], r.v[3]);
+        }
+
+        double normal1[BLOCO], normal2[BLOCO];
+        detalhe_philox::box_muller_bloco(u1, u2, tamanho, media, desvio, normal1, normal2);
+
+        // Intercala os pares; o último elemento de n ímpar fica só com o cosseno
+        for (size_t j = 0; j < tamanho; ++j) {
+            size_t i = 2 * (inicio + j);
+            saida[i] = normal1[j];
+            if (i + 1 < n) saida[i + 1] = normal2[j];
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <omp.h>
+
+// Buscas paralelas com saída antecipada: existe / todos / primeiro índice que satisfaz um
+// predicado.
+//
+// Os blocos de BLOCO_PREDICADO índices são distribuídos em ordem crescente por um contador
+// atômico (um schedule dinâmico feito à mão). Quem encontra uma testemunha baixa o índice
+// compartilhado `melhor` por CAS. Antes de pegar cada bloco a thread confere `melhor`:
+// blocos que começam depois da testemunha atual não são lidos. Como os blocos saem em
+// ordem, todo bloco anterior à testemunha já foi ou está sendo lido, e o resultado é
+// exatamente o primeiro índice, com qualquer número de threads.
+//
+// A verificação por bloco faz o papel do `omp cancel`, que só funciona com
+// OMP_CANCELLATION=true no ambiente.
+const size_t NAO_ENCONTRADO = SIZE_MAX;
+const size_t BLOCO_PREDICADO = 4096;
+
+namespace detalhe_predicados {
+
+// Primeiro i em [inicio, fim) com p(i), ou NAO_ENCONTRADO. O teste do bloco inteiro é um OR
+// sem desvios (vetoriza); só um bloco com testemunha é percorrido de novo até o primeiro acerto.
+template <typename PredicadoIndice>
+size_t primeiro_no_bloco(size_t inicio, size_t fim, PredicadoIndice p) {
+    int achou = 0;
+    #pragma omp simd reduction(|:achou)
+    for (size_t i = inicio; i < fim; ++i) {
+        achou |= p(i) ? 1 : 0;
+    }
+    if (!achou) return NAO_ENCONTRADO;
+    for (size_t i = inicio; i < fim; ++i) {
+        if (p(i)) return i;
+    }
+    return NAO_ENCONTRADO;
+}
+
+// primeiro = true: menor índice com p(i). primeiro = false: qualquer índice (para no primeiro achado).
+template <bool primeiro, typename PredicadoIndice>
+size_t buscar(size_t n, PredicadoIndice p) {
+    std::atomic<size_t> proximo_bloco(0);
+    std::atomic<size_t> melhor(NAO_ENCONTRADO);
+
+    #pragma omp parallel if(n > BLOCO_PREDICADO)
+    {
+        while (true) {
+            const size_t inicio = proximo_bloco.fetch_add(1, std::memory_order_relaxed) * BLOCO_PREDICADO;
+            if (inicio >= n) break;
+            const size_t atual = melhor.load(std::memory_order_relaxed);
+            if (primeiro ? inicio > atual : atual != NAO_ENCONTRADO) break;
+
+            const size_t fim = (n - inicio < BLOCO_PREDICADO) ? n : inicio + BLOCO_PREDICADO;
+            const size_t achado = primeiro_no_bloco(inicio, fim, p);
+            if (achado == NAO_ENCONTRADO) continue;
+
+            size_t esperado = melhor.load(std::memory_order_relaxed);
+            while (achado < esperado && !melhor.compare_exchange_weak(esperado, achado, std::memory_order_relaxed)) {
+            }
+        }
+    }
+    return melhor.load();
+}
+
+} // namespace detalhe_predicados
+
+// Versões sobre índices: o predicado recebe i e pode ler várias colunas
+template <typename PredicadoIndice>
+size_t encontrar_primeiro_indice(size_t n, PredicadoIndice p) {
+    return detalhe_predicados::buscar<true>(n, p);
+}
+
+template <typename PredicadoIndice>
+bool existe_indice(size_t n, PredicadoIndice p) {
+    return detalhe_predicados::buscar<false>(n, p) != NAO_ENCONTRADO;
+}
+
+// Versões sobre um vetor
+template <typename T, typename Predicado>
+size_t encontrar_primeiro(const T* dados, size_t n, Predicado p) {
+    return encontrar_primeiro_indice(n, [=](size_t i) { return p(dados[i]); });
+}
+
+template <typename T, typename Predicado>
+bool existe(const T* dados, size_t n, Predicado p) {
+    return existe_indice(n, [=](size_t i) { return p(dados[i]); });
+}
+
+template <typename T, typename Predicado>
+bool todos(const T* dados, size_t n, Predicado p) {
+    return !existe_indice(n, [=](size_t i) { return !p(dados[i]); });
+}
+
+// Primeiro elemento que viola p (NAO_ENCONTRADO se todos satisfazem): a testemunha de um "todos"
+template <typename T, typename Predicado>
+size_t primeira_violacao(const T* dados, size_t n, Predicado p) {
+    return encontrar_primeiro_indice(n, [=](size_t i) { return !p(dados[i]); });
+}
@@ -11,123 +11,140 @@
 #include <limits>
 #include <string>
 #include <omp.h>
+#include "reducoes.hpp"
+#include "centavos.hpp"
+#include "soma_reprodutivel.hpp"
+#include "predicados.hpp"
+#include "kernels_isa.hpp"
+#include "autoajuste.hpp"
+#include "numa.hpp"
 
 // Função auxiliar para gerar dados de exemplo
-std::vector<double> gerar_dados_aleatorios(int tamanho) {
-    std::vector<double> dados(tamanho);
-    #pragma omp parallel for
-    for (int i = 0; i < tamanho; ++i) {
-        dados[i] = static_cast<double>(i + 1) * 1.5;
-    }
-    return dados;
+// O preenchimento paralelo com schedule(static) é o primeiro toque: cada página fica no nó
+// NUMA da thread que depois a lê nas reductions
+BufferNuma<double> gerar_dados_aleatorios(int tamanho) {
+    return BufferNuma<double>(tamanho, [](size_t i) { return static_cast<double>(i + 1) * 1.5; });
 }
 
 int main() {
     const int N = 1000000;
-    std::vector<double> dados = gerar_dados_aleatorios(N);
+    fixar_threads(politica_do_ambiente());
+    BufferNuma<double> dados = gerar_dados_aleatorios(N);
     
     std::cout << "=== DEMONSTRAÇÃO DAS OPERAÇÕES DE REDUCTION NO OpenMP ===" << std::endl;
-    std::cout << "Tamanho do conjunto de dados: " << N << std::endl << std::endl;
+    std::cout << "Tamanho do conjunto de dados: " << N << std::endl;
+    // Mín/máx e operações bit a bit usam kernels escolhidos por CPUID (KERNELS_ISA força um nível)
+    std::cout << "Kernels vetoriais: " << kernels_isa().nome << std::endl;
+    // Custos da máquina (medidos uma vez e guardados em cache) usados para planejar cada laço
+    const CalibracaoHost& host = calibracao();
+    std::cout << "Calibração: fork/join " << host.fork_join_s * 1e6 << " µs, "
+              << host.custo_elemento_s * 1e9 << " ns/elemento" << std::endl << std::endl;
+
+    // Planos dos laços de tamanho N e do produto de N_mult elementos. Os laços daqui têm custo
+    // uniforme (não são `irregular`), então os planos só escolhem as threads e saem em static;
+    // o schedule(runtime) segue o plano e passaria a dynamic num laço planejado como irregular.
+    PlanoLaco plano_n = planejar(N);
 
     // 1. REDUCTION COM SOMA (+)
     double soma = 0.0;
-    #pragma omp parallel for reduction(+:soma)
+    aplicar(plano_n);
+    #pragma omp parallel for if(plano_n.paralelo) num_threads(plano_n.threads) schedule(runtime) reduction(+:soma)
     for (int i = 0; i < N; ++i) {
         soma += dados[i];
     }
     std::cout << "1. REDUCTION COM SOMA (+):" << std::endl;
     std::cout << "   Soma total: " << soma << std::endl;
-    std::cout << "   Média: " << soma / N << std::endl << std::endl;
+    std::cout << "   Média: " << soma / N << std::endl;
+    // Versão reprodutível: mesmos bits com qualquer OMP_NUM_THREADS e schedule
+    std::cout << "   Soma reprodutível: " << soma_reprodutivel(dados.data(), N) << std::endl << std::endl;
 
     // 2. REDUCTION COM MULTIPLICAÇÃO (*)
     double produto = 1.0;
     // Usamos um subconjunto menor para evitar overflow
     const int N_mult = 100;
-    #pragma omp parallel for reduction(*:produto)
+    // 100 elementos custam menos que abrir a região paralela: o plano sai serial
+    PlanoLaco plano_produto = planejar(N_mult);
+    aplicar(plano_produto);
+    #pragma omp parallel for if(plano_produto.paralelo) num_threads(plano_produto.threads) schedule(runtime) \
+        reduction(*:produto)
     for (int i = 0; i < N_mult; ++i) {
         produto *= (dados[i] / 1000.0); // Escalamos para evitar overflow
     }
     std::cout << "2. REDUCTION COM MULTIPLICAÇÃO (*):" << std::endl;
-    std::cout << "   Produto dos primeiros " << N_mult << " elementos (escalados): " << produto << std::endl << std::endl;
+    std::cout << "   Produto dos primeiros " << N_mult << " elementos (escalados): " << produto << std::endl;
+    std::cout << "   Plano do laço: " << descrever(plano_produto) << std::endl << std::endl;
 
     // 3. REDUCTION COM MÁXIMO (max)
-    double maximo = std::numeric_limits<double>::lowest();
-    #pragma omp parallel for reduction(max:maximo)
-    for (int i = 0; i < N; ++i) {
-        if (dados[i] > maximo) {
-            maximo = dados[i];
-        }
-    }
+    double maximo = maximo_isa(dados.data(), N);
     std::cout << "3. REDUCTION COM MÁXIMO (max):" << std::endl;
     std::cout << "   Valor máximo: " << maximo << std::endl << std::endl;
 
     // 4. REDUCTION COM MÍNIMO (min)
-    double minimo = std::numeric_limits<double>::max();
-    #pragma omp parallel for reduction(min:minimo)
-    for (int i = 0; i < N; ++i) {
-        if (dados[i] < minimo) {
-            minimo = dados[i];
-        }
-    }
+    double minimo = minimo_isa(dados.data(), N);
     std::cout << "4. REDUCTION COM MÍNIMO (min):" << std::endl;
     std::cout << "   Valor mínimo: " << minimo << std::endl << std::endl;
 
     // 5. REDUCTION COM OPERAÇÕES LÓGICAS - AND (&&)
     bool todos_positivos = true;
-    #pragma omp parallel for reduction(&&:todos_positivos)
+    aplicar(plano_n);
+    #pragma omp parallel for if(plano_n.paralelo) num_threads(plano_n.threads) schedule(runtime) \
+        reduction(&&:todos_positivos)
     for (int i = 0; i < N; ++i) {
         todos_positivos = todos_positivos && (dados[i] > 0);
     }
     std::cout << "5. REDUCTION COM AND LÓGICO (&&):" << std::endl;
-    std::cout << "   Todos os elementos são positivos? " << (todos_positivos ? "Sim" : "Não") << std::endl << std::endl;
+    std::cout << "   Todos os elementos são positivos? " << (todos_positivos ? "Sim" : "Não") << std::endl;
+    // Mesma pergunta com saída antecipada: as threads param no primeiro contraexemplo
+    size_t primeiro_nao_positivo = primeira_violacao(dados.data(), N, [](double x) { return x > 0; });
+    std::cout << "   Primeiro elemento não positivo (saída antecipada): "
+              << (primeiro_nao_positivo == NAO_ENCONTRADO ? std::string("nenhum") : std::to_string(primeiro_nao_positivo))
+              << std::endl;
+    size_t primeiro_acima_mil = encontrar_primeiro(dados.data(), N, [](double x) { return x > 1000.0; });
+    std::cout << "   Todos <= 1000? "
+              << (primeiro_acima_mil == NAO_ENCONTRADO
+                      ? std::string("Sim")
+                      : "Não (primeira violação no índice " + std::to_string(primeiro_acima_mil) + ")")
+              << std::endl << std::endl;
 
     // 6. REDUCTION COM OPERAÇÕES LÓGICAS - OR (||)
     bool existe_negativo = false;
-    #pragma omp parallel for reduction(||:existe_negativo)
+    aplicar(plano_n);
+    #pragma omp parallel for if(plano_n.paralelo) num_threads(plano_n.threads) schedule(runtime) \
+        reduction(||:existe_negativo)
     for (int i = 0; i < N; ++i) {
         existe_negativo = existe_negativo || (dados[i] < 0);
     }
     std::cout << "6. REDUCTION COM OR LÓGICO (||):" << std::endl;
-    std::cout << "   Existe algum elemento negativo? " << (existe_negativo ? "Sim" : "Não") << std::endl << std::endl;
+    std::cout << "   Existe algum elemento negativo? " << (existe_negativo ? "Sim" : "Não") << std::endl;
+    size_t primeiro_negativo = encontrar_primeiro(dados.data(), N, [](double x) { return x < 0; });
+    std::cout << "   Primeiro negativo (saída antecipada): "
+              << (primeiro_negativo == NAO_ENCONTRADO ? std::string("nenhum") : std::to_string(primeiro_negativo))
+              << std::endl << std::endl;
 
     // 7. REDUCTION COM BITWISE AND (&) - exemplo com inteiros
-    int bitmask_and = ~0; // Todos os bits 1
-    std::vector<int> inteiros(N);
-    #pragma omp parallel for
-    for (int i = 0; i < N; ++i) {
-        inteiros[i] = i + 1;
-    }
+    BufferNuma<int> inteiros(N, [](size_t i) { return static_cast<int>(i + 1); });
     
-    #pragma omp parallel for reduction(&:bitmask_and)
-    for (int i = 0; i < N; ++i) {
-        bitmask_and &= inteiros[i];
-    }
+    int bitmask_and = e_isa(inteiros.data(), N);
     std::cout << "7. REDUCTION COM BITWISE AND (&):" << std::endl;
     std::cout << "   Resultado do AND bit a bit: " << bitmask_and << std::endl << std::endl;
 
     // 8. REDUCTION COM BITWISE OR (|)
-    int bitmask_or = 0;
-    #pragma omp parallel for reduction(|:bitmask_or)
-    for (int i = 0; i < N; ++i) {
-        bitmask_or |= inteiros[i];
-    }
+    int bitmask_or = ou_isa(inteiros.data(), N);
     std::cout << "8. REDUCTION COM BITWISE OR (|):" << std::endl;
     std::cout << "   Resultado do OR bit a bit: " << bitmask_or << std::endl << std::endl;
 
     // 9. REDUCTION COM BITWISE XOR (^)
-    int bitwise_xor = 0;
-    #pragma omp parallel for reduction(^:bitwise_xor)
-    for (int i = 0; i < N; ++i) {
-        bitwise_xor ^= inteiros[i];
-    }
+    int bitwise_xor = xou_isa(inteiros.data(), N);
     std::cout << "9. REDUCTION COM BITWISE XOR (^):" << std::endl;
-    std::cout << "   Resultado do XOR bit a bit: " << bitwise_xor << std::endl << std::endl;
+    std::cout << "   Resultado do XOR bit a bit: " << bitwise_xor << std::endl;
+    std::cout << "   Total de bits 1 (popcount): " << popcount_isa(inteiros.data(), N) << std::endl << std::endl;
 
     // 10. EXEMPLO PRÁTICO: CÁLCULO DE VARIÂNCIA E DESVIO PADRÃO
     double media = soma / N;
     double variancia = 0.0;
     
-    #pragma omp parallel for reduction(+:variancia)
+    aplicar(plano_n);
+    #pragma omp parallel for if(plano_n.paralelo) num_threads(plano_n.threads) schedule(runtime) reduction(+:variancia)
     for (int i = 0; i < N; ++i) {
         double diff = dados[i] - media;
         variancia += diff * diff;
@@ -145,7 +162,10 @@ int main() {
     double max_multiplo = std::numeric_limits<double>::lowest();
     double min_multiplo = std::numeric_limits<double>::max();
     
-    #pragma omp parallel for reduction(+:soma_multipla) reduction(max:max_multiplo) reduction(min:min_multiplo)
+    PlanoLaco plano_multiplo = planejar(N, 1.5);  // três reduções por elemento
+    aplicar(plano_multiplo);
+    #pragma omp parallel for if(plano_multiplo.paralelo) num_threads(plano_multiplo.threads) schedule(runtime) \
+        reduction(+:soma_multipla) reduction(max:max_multiplo) reduction(min:min_multiplo)
     for (int i = 0; i < N; ++i) {
         soma_multipla += dados[i];
         if (dados[i] > max_multiplo) max_multiplo = dados[i];
@@ -156,7 +176,21 @@ int main() {
     std::cout << "    Soma: " << soma_multipla << std::endl;
     std::cout << "    Máximo: " << max_multiplo << std::endl;
     std::cout << "    Mínimo: " << min_multiplo << std::endl;
-    std::cout << "    Amplitude: " << (max_multiplo - min_multiplo) << std::endl << std::endl;
+    std::cout << "    Amplitude: " << (max_multiplo - min_multiplo) << std::endl;
+
+    // O mesmo laço composto pela biblioteca de reduções, com mais estatísticas juntas
+    auto [soma_fundida, max_fundido, min_fundido, welford_fundido, acima_da_media] = reducoes::reduzir(
+        dados.data(), N,
+        reducoes::Soma<double>(), reducoes::Max<double>(), reducoes::Min<double>(), reducoes::Welford(),
+        reducoes::contar_se([media](double x) { return x > media; }));
+    auto [and_fundido, or_fundido, xor_fundido] = reducoes::reduzir(
+        inteiros.data(), N, reducoes::E<int>(), reducoes::Ou<int>(), reducoes::Xou<int>());
+
+    std::cout << "    Biblioteca de reduções (laço único gerado em tempo de compilação):" << std::endl;
+    std::cout << "      Soma: " << soma_fundida << ", Máximo: " << max_fundido << ", Mínimo: " << min_fundido << std::endl;
+    std::cout << "      Desvio padrão (Welford): " << std::sqrt(welford_fundido.M2 / (welford_fundido.count - 1)) << std::endl;
+    std::cout << "      Elementos acima da média: " << acima_da_media << std::endl;
+    std::cout << "      AND/OR/XOR dos inteiros: " << and_fundido << " / " << or_fundido << " / " << xor_fundido << std::endl << std::endl;
 
     // 12. COMPARAÇÃO DE DESEMPENHO: COM E SEM REDUCTION
     std::cout << "12. COMPARAÇÃO DE DESEMPENHO:" << std::endl;
@@ -183,7 +217,38 @@ int main() {
     std::cout << "    Tempo sem reduction (critical): " << tempo_sem_reduction << " segundos" << std::endl;
     std::cout << "    Tempo com reduction: " << tempo_com_reduction << " segundos" << std::endl;
     std::cout << "    Speedup: " << (tempo_sem_reduction / tempo_com_reduction) << "x" << std::endl;
-    std::cout << "    Resultados são iguais? " << (soma_sem_reduction == soma_com_reduction ? "Sim" : "Não") << std::endl;
+    std::cout << "    Resultados são iguais? " << (soma_sem_reduction == soma_com_reduction ? "Sim" : "Não") << std::endl << std::endl;
+
+    // 13. MODO EXATO EM CENTAVOS (PONTO FIXO INTEIRO)
+    // A soma de doubles depende da ordem das parcelas; a de inteiros não.
+    ColunaCentavos centavos = para_centavos(dados.data(), N);
+    const bool estreita = centavos.estreita();
+    const int32_t* c32 = centavos.valores32.data();
+    const int64_t* c64 = centavos.valores64.data();
+
+    long long soma_centavos_critical = 0;
+    #pragma omp parallel for
+    for (int i = 0; i < N; ++i) {
+        #pragma omp critical
+        soma_centavos_critical += estreita ? c32[i] : c64[i];
+    }
+
+    long long soma_centavos_reduction = 0;
+    #pragma omp parallel for reduction(+:soma_centavos_reduction)
+    for (int i = 0; i < N; ++i) {
+        soma_centavos_reduction += estreita ? c32[i] : c64[i];
+    }
+
+    EstatisticasCentavos exatas = estatisticas_centavos(centavos);
+
+    std::cout << "13. MODO EXATO EM CENTAVOS (" << (centavos.estreita() ? "int32" : "int64") << "):" << std::endl;
+    std::cout << "    Soma (critical): R$ " << centavos_para_texto(soma_centavos_critical) << std::endl;
+    std::cout << "    Soma (reduction): R$ " << centavos_para_texto(soma_centavos_reduction) << std::endl;
+    std::cout << "    Resultados são iguais? " << (soma_centavos_critical == soma_centavos_reduction ? "Sim" : "Não") << std::endl;
+    std::cout << "    Mínimo: R$ " << centavos_para_texto(exatas.minimo)
+              << ", Máximo: R$ " << centavos_para_texto(exatas.maximo) << std::endl;
+    std::cout << "    Soma dos quadrados (centavos²): " << int128_para_texto(exatas.soma_quadrados) << std::endl;
+    std::cout << "    Desvio padrão: " << std::sqrt(exatas.variancia_amostral_reais()) << std::endl;
 
     return 0;
 }
@@ -4,58 +4,143 @@
 #include <omp.h>
 #include <iomanip>
 #include <random>
+#include <string>
+#include <cstdint>
+#include "welford.hpp"
+#include "philox.hpp"
+#include "soma_reprodutivel.hpp"
+#include "compensado.hpp"
+#include "numa.hpp"
 
-// Estrutura para acumular estatísticas online
-struct WelfordAccumulator {
-    double mean;
-    double M2;
-    long long count;
-    
-    WelfordAccumulator() : mean(0.0), M2(0.0), count(0) {}
-};
-
-// Função para combinar acumuladores (necessária para reduction customizada)
-void welford_combine(WelfordAccumulator& a, const WelfordAccumulator& b) {
-    if (b.count == 0) return;
-    if (a.count == 0) {
-        a = b;
-        return;
-    }
-    
-    long long total_count = a.count + b.count;
-    double delta = b.mean - a.mean;
-    
-    a.M2 += b.M2 + delta * delta * a.count * b.count / total_count;
-    a.mean = (a.count * a.mean + b.count * b.mean) / total_count;
-    a.count = total_count;
+// Completa com espaços até a largura em caracteres (setw conta bytes, e os acentos ocupam dois)
+static std::string alinhar_esquerda(const std::string& texto, size_t largura) {
+    size_t caracteres = 0;
+    for (unsigned char c : texto) caracteres += (c & 0xC0) != 0x80;
+    return texto + std::string(largura > caracteres ? largura - caracteres : 0, ' ');
 }
 
-// Função para atualizar acumulador com novo valor
-void welford_update(WelfordAccumulator& acc, double x) {
-    acc.count++;
-    double delta = x - acc.mean;
-    acc.mean += delta / acc.count;
-    double delta2 = x - acc.mean;
-    acc.M2 += delta * delta2;
+// Erro relativo de cada método (média e variância) e vazão, contra uma referência de duas
+// passadas com somas compensadas. Roda sobre os salários e sobre os mesmos salários
+// deslocados por uma constante grande, onde Σx² − (Σx)²/N sem compensação se perde.
+static void relatorio_precisao_desempenho(const double* d, size_t n, const std::string& rotulo) {
+
+    SomaNeumaier soma_ref = acumular_compensado<SomaNeumaier>(d, n);
+    const double media_ref = soma_ref.valor() / n;
+    SomaNeumaier desvios_ref;
+    #pragma omp parallel for reduction(soma_neumaier:desvios_ref)
+    for (size_t i = 0; i < n; ++i) {
+        desvios_ref.adicionar((d[i] - media_ref) * (d[i] - media_ref));
+    }
+    const double variancia_ref = desvios_ref.valor() / n;
+
+    struct Linha { std::string metodo; double media, variancia, tempo; bool tem_variancia; };
+    std::vector<Linha> linhas;
+    double inicio;
+
+    inicio = omp_get_wtime();
+    double s = 0.0;
+    #pragma omp parallel for reduction(+:s)
+    for (size_t i = 0; i < n; ++i) s += d[i];
+    linhas.push_back({"Soma ingênua (+)", s / n, 0.0, omp_get_wtime() - inicio, false});
+
+    inicio = omp_get_wtime();
+    SomaKahan kahan = acumular_compensado<SomaKahan>(d, n);
+    linhas.push_back({"Soma Kahan", kahan.valor() / n, 0.0, omp_get_wtime() - inicio, false});
+
+    inicio = omp_get_wtime();
+    SomaNeumaier neumaier = acumular_compensado<SomaNeumaier>(d, n);
+    linhas.push_back({"Soma Neumaier", neumaier.valor() / n, 0.0, omp_get_wtime() - inicio, false});
+
+    inicio = omp_get_wtime();
+    double pairwise = soma_pairwise(d, n);
+    linhas.push_back({"Soma pairwise", pairwise / n, 0.0, omp_get_wtime() - inicio, false});
+
+    inicio = omp_get_wtime();
+    double s1 = 0.0, s2 = 0.0;
+    #pragma omp parallel for reduction(+:s1, s2)
+    for (size_t i = 0; i < n; ++i) {
+        s1 += d[i];
+        s2 += d[i] * d[i];
+    }
+    linhas.push_back({"1 passada ingênua", s1 / n, (s2 - s1 * s1 / n) / n, omp_get_wtime() - inicio, true});
+
+    // Kahan elemento a elemento via reduction customizada, com a subtração final em double
+    inicio = omp_get_wtime();
+    SomaKahan k1, k2;
+    #pragma omp parallel for reduction(soma_kahan:k1, k2)
+    for (size_t i = 0; i < n; ++i) {
+        k1.adicionar(d[i]);
+        k2.adicionar(d[i] * d[i]);
+    }
+    linhas.push_back({"1 passada Kahan", k1.valor() / n,
+                      (k2.valor() - k1.valor() * k1.valor() / n) / n, omp_get_wtime() - inicio, true});
+
+    inicio = omp_get_wtime();
+    MomentosCompensados momentos = acumular_compensado<MomentosCompensados>(d, n);
+    linhas.push_back({"1 passada compensada", momentos.media(), momentos.variancia_populacional(),
+                      omp_get_wtime() - inicio, true});
+
+    inicio = omp_get_wtime();
+    double soma_2p = 0.0;
+    #pragma omp parallel for reduction(+:soma_2p)
+    for (size_t i = 0; i < n; ++i) soma_2p += d[i];
+    const double media_2p = soma_2p / n;
+    double desvios_2p = 0.0;
+    #pragma omp parallel for reduction(+:desvios_2p)
+    for (size_t i = 0; i < n; ++i) desvios_2p += (d[i] - media_2p) * (d[i] - media_2p);
+    linhas.push_back({"2 passadas", media_2p, desvios_2p / n, omp_get_wtime() - inicio, true});
+
+    inicio = omp_get_wtime();
+    WelfordAccumulator w = welford_paralelo(d, n);
+    linhas.push_back({"Welford", w.mean, w.M2 / w.count, omp_get_wtime() - inicio, true});
+
+    auto erro = [](double v, double ref) { return ref != 0.0 ? std::fabs(v - ref) / std::fabs(ref) : std::fabs(v); };
+
+    std::cout << "  " << rotulo << " (média " << std::fixed << std::setprecision(2) << media_ref
+              << ", variância " << variancia_ref << "):" << std::endl;
+    std::cout << "    " << alinhar_esquerda("Método", 24)
+              << std::setw(14) << "Erro média" << std::setw(14) << "Erro var."
+              << std::setw(12) << "Tempo (ms)" << std::setw(12) << "Melem/s" << std::endl;
+    for (const Linha& l : linhas) {
+        std::cout << "    " << alinhar_esquerda(l.metodo, 24)
+                  << std::scientific << std::setprecision(2) << std::setw(14) << erro(l.media, media_ref);
+        if (l.tem_variancia) {
+            std::cout << std::setw(14) << erro(l.variancia, variancia_ref);
+        } else {
+            std::cout << std::setw(14) << "-";
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << l.tempo * 1e3
+                  << std::setprecision(0) << std::setw(12) << n / l.tempo / 1e6 << std::endl;
+    }
+    std::cout << std::endl;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     const int N = 1000000;
-    std::vector<double> salarios(N);
+    fixar_threads(politica_do_ambiente());
+    // Sem zerar na thread principal: o primeiro toque é o preenchimento paralelo abaixo
+    BufferNuma<double> salarios(N);
     
-    // Gerador de números aleatórios
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<double> dist(5000.0, 1500.0);
+    // Semente: passada na linha de comando para repetir uma execução, ou aleatória
+    uint64_t semente;
+    if (argc > 1) {
+        semente = std::stoull(argv[1]);
+    } else {
+        std::random_device rd;
+        semente = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
     
-    // Inicialização dos salários com distribuição normal
+    // Inicialização dos salários com distribuição normal (gerador por contador:
+    // cada salário depende só de (semente, i), sem estado compartilhado entre threads)
+    preencher_normal(salarios.data(), N, semente, 5000.0, 1500.0);
     #pragma omp parallel for
     for (int i = 0; i < N; ++i) {
-        salarios[i] = std::max(1000.0, dist(gen)); // Salário mínimo de R$ 1000
+        salarios[i] = std::max(1000.0, salarios[i]); // Salário mínimo de R$ 1000
     }
     
     std::cout << "=== CÁLCULO DE VARIÂNCIA - COMPARAÇÃO DE MÉTODOS ===" << std::endl;
-    std::cout << "Tamanho do conjunto: " << N << " salários\n" << std::endl;
+    std::cout << "Tamanho do conjunto: " << N << " salários" << std::endl;
+    std::cout << "Semente: " << semente << "\n" << std::endl;
     
     // MÉTODO 1: Duas passadas (tradicional)
     std::cout << "1. MÉTODO TRADICIONAL (DUAS PASSADAS):" << std::endl;
@@ -88,20 +173,17 @@ int main() {
     std::cout << "   Desvio padrão: R$ " << std::sqrt(variancia_pop_2pass) << std::endl;
     std::cout << "   Tempo: " << std::setprecision(4) << tempo_2pass << " segundos" << std::endl << std::endl;
     
-    // MÉTODO 2: Uma passada com múltiplas reductions
-    std::cout << "2. MÉTODO UMA PASSADA (MÚLTIPLAS REDUCTIONS):" << std::endl;
+    // MÉTODO 2: Uma passada com Σx e Σx² compensados (reduction customizada)
+    std::cout << "2. MÉTODO UMA PASSADA (Σx E Σx² COMPENSADOS):" << std::endl;
     inicio = omp_get_wtime();
     
-    double soma1 = 0.0, soma2 = 0.0;
-    #pragma omp parallel for reduction(+:soma1) reduction(+:soma2)
-    for (int i = 0; i < N; ++i) {
-        soma1 += salarios[i];
-        soma2 += salarios[i] * salarios[i];
-    }
+    // Somas de Neumaier por lane SIMD, erro exato de cada x² via fma e (Σx)²/N em
+    // double-double: soma2 - soma1²/N sem cancelamento catastrófico
+    MomentosCompensados momentos = acumular_compensado<MomentosCompensados>(salarios.data(), N);
     
-    double media_1pass = soma1 / N;
-    double variancia_pop_1pass = (soma2 - (soma1 * soma1) / N) / N;
-    double variancia_amostral_1pass = (soma2 - (soma1 * soma1) / N) / (N - 1);
+    double media_1pass = momentos.media();
+    double variancia_pop_1pass = momentos.variancia_populacional();
+    double variancia_amostral_1pass = momentos.variancia_amostral();
     double tempo_1pass = omp_get_wtime() - inicio;
     
     std::cout << std::fixed << std::setprecision(2);
@@ -115,24 +197,9 @@ int main() {
     std::cout << "3. ALGORITMO DE WELFORD (ONLINE, UMA PASSADA):" << std::endl;
     inicio = omp_get_wtime();
     
-    // Para paralelizar Welford, precisamos de reduction customizada
-    // Vamos usar uma abordagem com seções críticas para demonstração
-    WelfordAccumulator global_acc;
-    
-    #pragma omp parallel
-    {
-        WelfordAccumulator local_acc;
-        
-        #pragma omp for
-        for (int i = 0; i < N; ++i) {
-            welford_update(local_acc, salarios[i]);
-        }
-        
-        #pragma omp critical
-        {
-            welford_combine(global_acc, local_acc);
-        }
-    }
+    // Welford vetorizado: acumuladores independentes por lane SIMD em blocos do tamanho
+    // da L1, combinados pela fórmula de Chan (welford_combine) via reduction customizada
+    WelfordAccumulator global_acc = welford_paralelo(salarios.data(), N);
     
     double variancia_pop_welford = global_acc.M2 / global_acc.count;
     double variancia_amostral_welford = global_acc.M2 / (global_acc.count - 1);
@@ -145,6 +212,28 @@ int main() {
     std::cout << "   Desvio padrão: R$ " << std::sqrt(variancia_pop_welford) << std::endl;
     std::cout << "   Tempo: " << std::setprecision(4) << tempo_welford << " segundos" << std::endl << std::endl;
     
+    // MÉTODO 4: Reduções reprodutíveis (mesmos bits com qualquer número de threads)
+    std::cout << "4. MODO REPRODUTÍVEL (BLOCOS FIXOS + ÁRVORE FIXA):" << std::endl;
+    inicio = omp_get_wtime();
+    double soma_reprodutivel_total = soma_reprodutivel(salarios.data(), N);
+    WelfordAccumulator acc_reprodutivel = welford_reprodutivel(salarios.data(), N);
+    double tempo_reprodutivel = omp_get_wtime() - inicio;
+    
+    // Repete com uma única thread: os bits devem ser os mesmos
+    int threads_originais = omp_get_max_threads();
+    omp_set_num_threads(1);
+    double soma_1_thread = soma_reprodutivel(salarios.data(), N);
+    WelfordAccumulator acc_1_thread = welford_reprodutivel(salarios.data(), N);
+    omp_set_num_threads(threads_originais);
+    bool bits_iguais = soma_1_thread == soma_reprodutivel_total &&
+                       acc_1_thread.mean == acc_reprodutivel.mean && acc_1_thread.M2 == acc_reprodutivel.M2;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "   Média: R$ " << soma_reprodutivel_total / N << std::endl;
+    std::cout << "   Variância populacional (Welford): R$ " << acc_reprodutivel.M2 / acc_reprodutivel.count << std::endl;
+    std::cout << "   Bits idênticos com 1 e " << threads_originais << " threads? " << (bits_iguais ? "Sim" : "Não") << std::endl;
+    std::cout << "   Tempo (soma + Welford): " << std::setprecision(4) << tempo_reprodutivel << " segundos" << std::endl << std::endl;
+    
     // COMPARAÇÃO DOS MÉTODOS
     std::cout << "=== COMPARAÇÃO FINAL ===" << std::endl;
     std::cout << "Diferença na média: R$ " << std::fabs(media - global_acc.mean) << std::endl;
@@ -162,16 +251,17 @@ int main() {
     std::cout << "Erro relativo 1-passada: " << std::fabs(variancia_pop_1pass - variancia_pop_2pass) / variancia_pop_2pass << std::endl;
     std::cout << "Erro relativo Welford: " << std::fabs(variancia_pop_welford - variancia_pop_2pass) / variancia_pop_2pass << std::endl;
     
+    // RELATÓRIO PRECISÃO x DESEMPENHO
+    std::cout << std::endl << "=== PRECISÃO x DESEMPENHO ===" << std::endl;
+    relatorio_precisao_desempenho(salarios.data(), N, "Salários");
+    BufferNuma<double> deslocados(N, [&salarios](size_t i) { return salarios[i] + 1e8; });
+    relatorio_precisao_desempenho(deslocados.data(), N, "Salários + 1e8");
+    
     return 0;
 }
 
 // Implementação alternativa com user-defined reduction (C++17)
-#pragma omp declare reduction( \
-    welford_combine_reduction : \
-    WelfordAccumulator : \
-    welford_combine(omp_out, omp_in) \
-) initializer(omp_priv = WelfordAccumulator())
-
+// (welford_combine_reduction é declarada em welford.hpp)
 void exemplo_com_user_defined_reduction() {
     const int N = 100000;
     std::vector<double> dados(N, 1.0);
@@ -1,25 +1,34 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <string>
 #include <omp.h>
 #include <iomanip>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+#include "funcionarios.hpp"
+#include "auditoria.hpp"
+#include "indice_bitmap.hpp"
+#include "agrupamento.hpp"
+#include "ingestao_csv.hpp"
 
-struct Funcionario {
-    double salario;
-    int departamento;
-    int idade;
-    double horas_trabalhadas;
-    std::string nome;
-    
-    Funcionario(double s, int d, int i, double h, const std::string& n) 
-        : salario(s), departamento(d), idade(i), horas_trabalhadas(h), nome(n) {}
-};
+// Quantidade de dígitos decimais de um inteiro não negativo
+static size_t contar_digitos(int x) {
+    size_t digitos = 1;
+    while (x >= 10) {
+        x /= 10;
+        ++digitos;
+    }
+    return digitos;
+}
 
 // Função para gerar dados de exemplo mais realistas
-std::vector<Funcionario> gerar_dados_funcionarios(int N) {
-    std::vector<Funcionario> funcionarios;
-    funcionarios.reserve(N);
+// Cada linha é escrita direto no seu índice, sem travas: a ordem das linhas é sempre i.
+TabelaFuncionarios gerar_dados_funcionarios(int N) {
+    TabelaFuncionarios tabela;
+    tabela.redimensionar(N);
     
     std::vector<std::string> nomes = {
         "Ana Silva", "Carlos Santos", "Maria Oliveira", "João Pereira", 
@@ -27,170 +36,219 @@ std::vector<Funcionario> gerar_dados_funcionarios(int N) {
         "Amanda Rocha", "Lucas Barbosa", "Patrícia Martins", "Roberto Ferreira"
     };
     
+    // Colunas numéricas + tamanho de cada nome ("<nome> <i>")
+    #pragma omp parallel for
+    for (int i = 0; i < N; ++i) {
+        tabela.salario[i] = 2000.0 + (i % 100) * 50.0;
+        tabela.departamento[i] = (i % 5) + 1;
+        tabela.idade[i] = 25 + (i % 40);
+        tabela.horas_trabalhadas[i] = 160.0 + (i % 80);
+        tabela.inicio_nome[i + 1] = nomes[i % nomes.size()].size() + 1 + contar_digitos(i);
+    }
+    
+    // Soma de prefixos: posição de cada nome na arena
+    for (int i = 0; i < N; ++i) {
+        tabela.inicio_nome[i + 1] += tabela.inicio_nome[i];
+    }
+    tabela.arena_nomes.resize(tabela.inicio_nome[N]);
+    
+    // Cada thread escreve os nomes das suas linhas em regiões disjuntas da arena
     #pragma omp parallel for
     for (int i = 0; i < N; ++i) {
-        double salario = 2000.0 + (i % 100) * 50.0;
-        int departamento = (i % 5) + 1;
-        int idade = 25 + (i % 40);
-        double horas = 160.0 + (i % 80);
-        std::string nome = nomes[i % nomes.size()] + " " + std::to_string(i);
-        
-        #pragma omp critical
-        funcionarios.emplace_back(salario, departamento, idade, horas, nome);
+        const std::string& base = nomes[i % nomes.size()];
+        char* destino = &tabela.arena_nomes[tabela.inicio_nome[i]];
+        char* fim = &tabela.arena_nomes[0] + tabela.inicio_nome[i + 1];
+        destino = std::copy(base.begin(), base.end(), destino);
+        *destino++ = ' ';
+        std::to_chars(destino, fim, i);
     }
     
-    return funcionarios;
+    return tabela;
 }
 
-int main() {
-    const int N = 100000;
-    auto funcionarios = gerar_dados_funcionarios(N);
+// Índice de violações guardado em `caminho`: lido se o arquivo for válido e bater com a
+// auditoria atual (mesmas linhas e mesma contagem em cada regra); senão construído e gravado.
+IndiceAuditoria indice_persistente(const std::string& caminho, const TabelaFuncionarios& tabela,
+                                   const ResultadoAuditoria& auditoria) {
+    double inicio = omp_get_wtime();
+    std::ifstream entrada(caminho, std::ios::binary);
+    if (entrada) {
+        try {
+            IndiceAuditoria indice;
+            indice.carregar(entrada);
+            const bool confere = indice.linhas() == tabela.tamanho() &&
+                indice.regra(VIOLA_PISO).cardinalidade() == static_cast<size_t>(auditoria.violacoes_piso) &&
+                indice.regra(VIOLA_TETO).cardinalidade() == static_cast<size_t>(auditoria.violacoes_teto) &&
+                indice.regra(VIOLA_IDADE).cardinalidade() == static_cast<size_t>(auditoria.violacoes_idade) &&
+                indice.regra(VIOLA_HORAS).cardinalidade() == static_cast<size_t>(auditoria.violacoes_horas);
+            if (confere) {
+                const auto precisao = std::cout.precision(3);
+                std::cout << "Índice lido de " << caminho << " em " << (omp_get_wtime() - inicio) * 1e3 << " ms"
+                          << std::endl;
+                std::cout.precision(precisao);
+                return indice;
+            }
+            std::cout << "Índice " << caminho << " é de outra tabela: construindo de novo" << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "Índice " << caminho << " inválido (" << e.what() << "): construindo de novo" << std::endl;
+        }
+    }
+
+    IndiceAuditoria indice = IndiceAuditoria::construir(tabela, auditoria);
+    std::ofstream saida(caminho, std::ios::binary);
+    indice.salvar(saida);
+    saida.close();
+    if (!saida) {
+        std::cerr << "aviso: não foi possível gravar o índice em " << caminho << std::endl;
+    } else {
+        std::cout << "Índice gravado em " << caminho << std::endl;
+    }
+    return indice;
+}
+
+// Uso: ./q3 [--csv funcionarios.csv] [--indice violacoes.idx]
+// O CSV precisa das colunas salario, departamento, idade e horas_trabalhadas (nome é opcional).
+// Com --indice, o índice de violações é gravado no arquivo e reaproveitado nas próximas
+// execuções sobre a mesma tabela.
+int main(int argc, char* argv[]) {
+    std::string caminho_csv, caminho_indice;
+    for (int i = 1; i < argc; i += 2) {
+        std::string opcao = argv[i];
+        if (i + 1 == argc || (opcao != "--csv" && opcao != "--indice")) {
+            std::cerr << "Uso: " << argv[0] << " [--csv funcionarios.csv] [--indice violacoes.idx]" << std::endl;
+            return 1;
+        }
+        (opcao == "--csv" ? caminho_csv : caminho_indice) = argv[i + 1];
+    }
+
+    TabelaFuncionarios funcionarios;
+    if (!caminho_csv.empty()) {
+        ResumoIngestao ingestao;
+        try {
+            funcionarios = ler_funcionarios_csv(caminho_csv, OpcoesCsv(), &ingestao);
+        } catch (const std::exception& e) {
+            std::cerr << "Erro: " << e.what() << std::endl;
+            return 1;
+        }
+        if (funcionarios.tamanho() == 0) {
+            std::cerr << "Erro: " << caminho_csv << " não tem linhas de dados" << std::endl;
+            return 1;
+        }
+        std::cout << "CSV " << caminho_csv << ": " << ingestao.linhas << " linhas em " << std::fixed
+                  << std::setprecision(3) << ingestao.segundos << " s (" << std::setprecision(0)
+                  << ingestao.mb_por_s() << " MB/s)" << std::endl << std::endl;
+    } else {
+        funcionarios = gerar_dados_funcionarios(100000);
+    }
+    const int N = static_cast<int>(funcionarios.tamanho());
     
     std::cout << "=== AUDITORIA AVANÇADA DE DADOS FUNCIONAIS ===" << std::endl;
     std::cout << "Total de funcionários: " << N << std::endl << std::endl;
 
-    // CONSTANTES DE NEGÓCIO
-    const double PISO_SALARIAL = 1500.0;
-    const double TETO_SALARIAL = 20000.0;
-    const int IDADE_MINIMA = 18;
-    const int IDADE_MAXIMA = 70;
-    const double HORAS_MINIMAS = 80.0;
-    const double HORAS_MAXIMAS = 220.0;
+    // Todas as regras avaliadas em uma única passada; os relatórios 1-4 saem dela
+    RegrasAuditoria regras;
+    ResultadoAuditoria auditoria = auditar(funcionarios, regras);
 
     // 1. AUDITORIA BÁSICA (similar ao exemplo anterior)
-    bool piso_violado = false;
-    bool teto_violado = false;
-    bool dados_validos = true;
-
-    #pragma omp parallel for \
-        reduction(||:piso_violado, teto_violado) \
-        reduction(&&:dados_validos)
-    for (int i = 0; i < N; ++i) {
-        const auto& f = funcionarios[i];
-        
-        if (f.salario < PISO_SALARIAL) piso_violado = true;
-        if (f.salario > TETO_SALARIAL) teto_violado = true;
-        if (f.salario <= 0 || f.idade <= 0 || f.horas_trabalhadas <= 0) {
-            dados_validos = false;
-        }
-    }
+    // As flags vêm das contagens da auditoria; a primeira testemunha de cada regra violada sai
+    // da máscara, numa busca que para no primeiro acerto (regras sem violação não leem nada)
+    double inicio_verificacao = omp_get_wtime();
+    auto primeiro = [&](bool violada, uint8_t bits) { return violada ? auditoria.primeiro_com(bits) : NAO_ENCONTRADO; };
+    const size_t primeiro_abaixo_piso = primeiro(auditoria.piso_violado(), VIOLA_PISO);
+    const size_t primeiro_acima_teto = primeiro(auditoria.teto_violado(), VIOLA_TETO);
+    const size_t primeiro_invalido = primeiro(!auditoria.dados_validos(), DADO_INVALIDO);
+    double tempo_verificacao = omp_get_wtime() - inicio_verificacao;
 
+    auto testemunha = [&](size_t i) {
+        if (i == NAO_ENCONTRADO) return std::string();
+        return " (primeiro: " + std::string(funcionarios.nome(i)) + ", linha " + std::to_string(i) + ")";
+    };
     std::cout << "1. AUDITORIA BÁSICA DE CONSISTÊNCIA:" << std::endl;
-    std::cout << "   Piso violado: " << (piso_violado ? "SIM" : "NÃO") << std::endl;
-    std::cout << "   Teto violado: " << (teto_violado ? "SIM" : "NÃO") << std::endl;
-    std::cout << "   Dados válidos: " << (dados_validos ? "SIM" : "NÃO") << std::endl << std::endl;
+    std::cout << "   Piso violado: " << (auditoria.piso_violado() ? "SIM" : "NÃO")
+              << testemunha(primeiro_abaixo_piso) << std::endl;
+    std::cout << "   Teto violado: " << (auditoria.teto_violado() ? "SIM" : "NÃO")
+              << testemunha(primeiro_acima_teto) << std::endl;
+    std::cout << "   Dados válidos: " << (auditoria.dados_validos() ? "SIM" : "NÃO")
+              << testemunha(primeiro_invalido) << std::endl;
+    std::cout << "   Tempo das testemunhas: " << std::fixed << std::setprecision(2) << tempo_verificacao * 1e6
+              << " µs" << std::endl << std::endl;
 
     // 2. AUDITORIA AVANÇADA COM CONTAGEM DE VIOLAÇÕES
-    int violacoes_piso = 0;
-    int violacoes_teto = 0;
-    int violacoes_idade = 0;
-    int violacoes_horas = 0;
-    int violacoes_multiplas = 0;
-
-    #pragma omp parallel for \
-        reduction(+:violacoes_piso, violacoes_teto, violacoes_idade, violacoes_horas, violacoes_multiplas)
-    for (int i = 0; i < N; ++i) {
-        const auto& f = funcionarios[i];
-        int violacoes_local = 0;
-        
-        if (f.salario < PISO_SALARIAL) {
-            violacoes_piso++;
-            violacoes_local++;
-        }
-        if (f.salario > TETO_SALARIAL) {
-            violacoes_teto++;
-            violacoes_local++;
-        }
-        if (f.idade < IDADE_MINIMA || f.idade > IDADE_MAXIMA) {
-            violacoes_idade++;
-            violacoes_local++;
-        }
-        if (f.horas_trabalhadas < HORAS_MINIMAS || f.horas_trabalhadas > HORAS_MAXIMAS) {
-            violacoes_horas++;
-            violacoes_local++;
-        }
-        if (violacoes_local >= 2) {
-            violacoes_multiplas++;
-        }
-    }
+    long long violacoes_piso = auditoria.violacoes_piso;
+    long long violacoes_teto = auditoria.violacoes_teto;
+    long long violacoes_idade = auditoria.violacoes_idade;
+    long long violacoes_horas = auditoria.violacoes_horas;
 
     std::cout << "2. ESTATÍSTICAS DETALHADAS DE VIOLAÇÕES:" << std::endl;
     std::cout << "   Violações de piso salarial: " << violacoes_piso << std::endl;
     std::cout << "   Violações de teto salarial: " << violacoes_teto << std::endl;
     std::cout << "   Violações de idade: " << violacoes_idade << std::endl;
     std::cout << "   Violações de horas: " << violacoes_horas << std::endl;
-    std::cout << "   Funcionários com múltiplas violações: " << violacoes_multiplas << std::endl << std::endl;
+    std::cout << "   Funcionários com múltiplas violações: " << auditoria.violacoes_multiplas << std::endl << std::endl;
 
     // 3. VERIFICAÇÃO DE CONSISTÊNCIA ENTRE DEPARTAMENTOS
-    bool salarios_consistentes = true;
-    bool horas_consistentes = true;
-    double menor_salario_global = std::numeric_limits<double>::max();
-    double maior_salario_global = std::numeric_limits<double>::lowest();
-
-    #pragma omp parallel for \
-        reduction(&&:salarios_consistentes, horas_consistentes) \
-        reduction(min:menor_salario_global) \
-        reduction(max:maior_salario_global)
-    for (int i = 0; i < N; ++i) {
-        const auto& f = funcionarios[i];
-        
-        // Verifica consistência salarial por departamento
-        double salario_medio_esperado = 3000.0 + f.departamento * 500.0;
-        double margem_erro = salario_medio_esperado * 0.3; // 30% de margem
-        
-        if (std::fabs(f.salario - salario_medio_esperado) > margem_erro) {
-            salarios_consistentes = false;
-        }
-        
-        // Verifica consistência de horas
-        if (f.horas_trabalhadas < HORAS_MINIMAS || f.horas_trabalhadas > HORAS_MAXIMAS) {
-            horas_consistentes = false;
-        }
-        
-        // Atualiza min/max
-        if (f.salario < menor_salario_global) menor_salario_global = f.salario;
-        if (f.salario > maior_salario_global) maior_salario_global = f.salario;
-    }
+    double menor_salario_global = auditoria.menor_salario;
+    double maior_salario_global = auditoria.maior_salario;
 
     std::cout << "3. ANÁLISE DE CONSISTÊNCIA:" << std::endl;
     std::cout << std::fixed << std::setprecision(2);
-    std::cout << "   Salários consistentes por departamento: " << (salarios_consistentes ? "SIM" : "NÃO") << std::endl;
-    std::cout << "   Horas consistentes: " << (horas_consistentes ? "SIM" : "NÃO") << std::endl;
+    std::cout << "   Salários consistentes por departamento: " << (auditoria.salarios_consistentes() ? "SIM" : "NÃO") << std::endl;
+    std::cout << "   Horas consistentes: " << (auditoria.horas_consistentes() ? "SIM" : "NÃO") << std::endl;
     std::cout << "   Menor salário: R$ " << menor_salario_global << std::endl;
     std::cout << "   Maior salário: R$ " << maior_salario_global << std::endl;
     std::cout << "   Amplitude salarial: R$ " << (maior_salario_global - menor_salario_global) << std::endl << std::endl;
 
     // 4. DETECÇÃO DE ANOMALIAS ESTATÍSTICAS
-    double soma_salarios = 0.0;
-    double soma_quadrados = 0.0;
-    int contagem_anomalias = 0;
-
-    #pragma omp parallel for \
-        reduction(+:soma_salarios, soma_quadrados, contagem_anomalias)
-    for (int i = 0; i < N; ++i) {
-        soma_salarios += funcionarios[i].salario;
-        soma_quadrados += funcionarios[i].salario * funcionarios[i].salario;
-    }
-
-    double media_salarios = soma_salarios / N;
-    double desvio_padrao = std::sqrt((soma_quadrados / N) - (media_salarios * media_salarios));
+    // Σs² − (Σs)²/N com somas compensadas: a fórmula de uma passada sem cancelamento catastrófico
+    double media_salarios = auditoria.momentos_salario.media();
+    double desvio_padrao = std::sqrt(auditoria.momentos_salario.variancia_populacional());
     
-    // Segunda passada para detectar anomalias
-    #pragma omp parallel for reduction(+:contagem_anomalias)
-    for (int i = 0; i < N; ++i) {
-        double z_score = std::fabs((funcionarios[i].salario - media_salarios) / desvio_padrao);
-        if (z_score > 3.0) { // Mais de 3 desvios padrão da média
-            contagem_anomalias++;
-        }
-    }
+    // Só relê a coluna de salários se o menor ou o maior salário já passar de 3 desvios
+    long long contagem_anomalias = contar_anomalias_zscore(funcionarios, auditoria, media_salarios, desvio_padrao);
 
     std::cout << "4. DETECÇÃO DE ANOMALIAS ESTATÍSTICAS:" << std::endl;
     std::cout << "   Média salarial: R$ " << media_salarios << std::endl;
     std::cout << "   Desvio padrão: R$ " << desvio_padrao << std::endl;
     std::cout << "   Anomalias detectadas (Z-score > 3): " << contagem_anomalias << std::endl << std::endl;
 
-    // 5. RELATÓRIO FINAL DE QUALIDADE
-    std::cout << "5. RELATÓRIO FINAL DE QUALIDADE DOS DADOS:" << std::endl;
+    // 5. ESTATÍSTICAS POR DEPARTAMENTO (group-by em uma única passada)
+    int maior_departamento = *std::max_element(funcionarios.departamento.begin(), funcionarios.departamento.end());
+    std::vector<EstatisticaGrupo> por_departamento = agrupar(
+        funcionarios.departamento.data(), funcionarios.salario.data(), N, maior_departamento + 1);
+
+    std::cout << "5. ESTATÍSTICAS POR DEPARTAMENTO:" << std::endl;
+    for (int d = 0; d <= maior_departamento; ++d) {
+        const EstatisticaGrupo& g = por_departamento[d];
+        if (g.contagem() == 0) continue;
+        std::cout << "   Departamento " << d << ": " << g.contagem() << " funcionários, média R$ " << g.media()
+                  << ", desvio R$ " << g.desvio_amostral()
+                  << ", faixa R$ " << g.minimo << " - " << g.maximo << std::endl;
+    }
+    std::cout << std::endl;
+
+    // 6. CONSULTAS SOBRE O ÍNDICE DE VIOLAÇÕES (sem reler a tabela)
+    IndiceAuditoria indice = caminho_indice.empty() ? IndiceAuditoria::construir(funcionarios, auditoria)
+                                                    : indice_persistente(caminho_indice, funcionarios, auditoria);
+    
+    double inicio_consulta = omp_get_wtime();
+    BitmapCompactado piso_e_horas_depto3 =
+        indice.regra(VIOLA_PISO) & indice.regra(VIOLA_HORAS) & indice.departamento(3);
+    BitmapCompactado horas_depto3 = indice.regra(VIOLA_HORAS) & indice.departamento(3);
+    BitmapCompactado piso_ou_teto = indice.regra(VIOLA_PISO) | indice.regra(VIOLA_TETO);
+    double tempo_consulta = omp_get_wtime() - inicio_consulta;
+    
+    std::cout << "6. CONSULTAS NO ÍNDICE DE VIOLAÇÕES:" << std::endl;
+    std::cout << "   Piso E horas no departamento 3: " << piso_e_horas_depto3.cardinalidade() << std::endl;
+    std::cout << "   Horas no departamento 3: " << horas_depto3.cardinalidade() << std::endl;
+    std::cout << "   Piso OU teto: " << piso_ou_teto.cardinalidade() << std::endl;
+    std::cout << "   Primeiros funcionários com horas irregulares no departamento 3:" << std::endl;
+    for (uint32_t i : horas_depto3.para_vetor(3)) {
+        std::cout << "     - " << funcionarios.nome(i) << " (" << funcionarios.horas_trabalhadas[i] << " h)" << std::endl;
+    }
+    std::cout << "   Tempo das consultas: " << tempo_consulta * 1e6 << " µs" << std::endl << std::endl;
+
+    // 7. RELATÓRIO FINAL DE QUALIDADE
+    std::cout << "7. RELATÓRIO FINAL DE QUALIDADE DOS DADOS:" << std::endl;
     
     double taxa_erro_total = (violacoes_piso + violacoes_teto + violacoes_idade + violacoes_horas) / (4.0 * N);
     double qualidade_geral = (1.0 - taxa_erro_total) * 100.0;
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <string>
 #include <random>
@@ -6,6 +7,70 @@
 #include <cmath>
 #include <map>
 #include <iomanip>
+#include <cstdint>
+#include <stdexcept>
+#include <omp.h>
+#include "quantis.hpp"
+#include "esboco_quantis.hpp"
+#include "estatisticas.hpp"
+#include "agrupamento.hpp"
+#include "snapshot.hpp"
+#include "ingestao_csv.hpp"
+#include "streaming.hpp"
+#include "ordenacao_radix.hpp"
+
+// Salários com as colunas de chave usadas para gerá-los (códigos numéricos;
+// os nomes ficam nas tabelas de BigTechSalaries)
+struct SalaryDataset {
+    std::vector<double> salaries;
+    std::vector<uint8_t> department;  // índice em deptKeys
+    std::vector<uint8_t> country;     // índice em countries
+    std::vector<uint8_t> level;       // nível do cargo (0 = Júnior ... 4 = Diretoria)
+};
+
+// Visão das colunas usadas pelas análises, com os nomes de cada código. Aponta para um
+// SalaryDataset em memória ou direto para um snapshot mapeado (sem cópia).
+struct SalaryColumns {
+    const double* salaries = nullptr;
+    const uint8_t* department = nullptr;
+    const uint8_t* country = nullptr;
+    const uint8_t* level = nullptr;
+    size_t size = 0;
+    std::vector<std::string> departmentNames;
+    std::vector<std::string> countryNames;
+    std::vector<std::string> levelNames;
+};
+
+// Confere que todo código de uma coluna tem nome no dicionário: o snapshot pode vir de outra
+// ferramenta, e as análises indexam as tabelas de nomes direto pelo código
+void checkCodes(const uint8_t* codes, size_t n, size_t dictionarySize, const std::string& column) {
+    int maxCode = -1;
+    #pragma omp parallel for reduction(max:maxCode) schedule(static)
+    for (size_t i = 0; i < n; ++i) {
+        maxCode = std::max(maxCode, static_cast<int>(codes[i]));
+    }
+    if (maxCode >= static_cast<int>(dictionarySize)) {
+        throw std::runtime_error("coluna " + column + ": código " + std::to_string(maxCode) +
+                                 " fora do dicionário (" + std::to_string(dictionarySize) + " nomes)");
+    }
+}
+
+// Colunas de um snapshot gravado por BigTechSalaries::writeSnapshot
+SalaryColumns columnsFromSnapshot(const Snapshot& snapshot) {
+    SalaryColumns columns;
+    columns.salaries = snapshot.coluna<double>("salario").data();
+    columns.department = snapshot.coluna<uint8_t>("departamento").data();
+    columns.country = snapshot.coluna<uint8_t>("pais").data();
+    columns.level = snapshot.coluna<uint8_t>("nivel").data();
+    columns.size = snapshot.linhas();
+    columns.departmentNames = snapshot.dicionario("departamento");
+    columns.countryNames = snapshot.dicionario("pais");
+    columns.levelNames = snapshot.dicionario("nivel");
+    checkCodes(columns.department, columns.size, columns.departmentNames.size(), "departamento");
+    checkCodes(columns.country, columns.size, columns.countryNames.size(), "pais");
+    checkCodes(columns.level, columns.size, columns.levelNames.size(), "nivel");
+    return columns;
+}
 
 class BigTechSalaries {
 private:
@@ -15,12 +80,36 @@ private:
     std::vector<std::string> countries;
     std::vector<std::string> regions;
 
-    // Gerador de números aleatórios
-    std::random_device rd;
-    std::mt19937 gen;
+    // Semente do gerador (cada bloco de salários deriva sua própria sequência dela)
+    uint64_t seed;
+
+    // Modelo salarial compilado em tabelas numéricas planas (preenchidas no construtor)
+    std::vector<std::string> deptKeys;           // código do departamento -> chave ("CLD", "DS", ...)
+    std::vector<double> deptMultiplierTable;     // por código de departamento
+    std::vector<int> deptLevelCount;             // número de cargos por departamento
+    std::vector<double> countryMultiplierTable;  // por índice em countries
+    std::vector<double> baseSalaryTable;         // por nível
+    std::vector<std::string> levelNames;         // por nível
+
+    // Buffer de trabalho reaproveitado entre chamadas para o cálculo de percentis
+    SeletorQuantis percentileSelector;
 
 public:
-    BigTechSalaries() : gen(rd()) {
+    // Quantidade de salários gerada com a mesma sequência aleatória; define a
+    // reprodutibilidade, então não depende do número de threads.
+    static constexpr int GENERATION_BLOCK = 1 << 16;
+
+    // Mistura splitmix64: deriva sementes independentes por bloco a partir da semente global
+    static uint64_t mixSeed(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    BigTechSalaries() : BigTechSalaries((static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()) {}
+
+    explicit BigTechSalaries(uint64_t generatorSeed) : seed(generatorSeed) {
         companyName = "NexusTech Solutions";
         
         // Departamentos
@@ -43,18 +132,6 @@ public:
         
         countries = {"Brasil", "Estados Unidos", "Canadá", "México", "Argentina", "Chile"};
         regions = {"Norte", "Sul", "Centro-Oeste", "Sudeste", "Noroeste"};
-    }
-
-    std::vector<double> generateSalaries(int numSalaries = 2000000) {
-        std::cout << "Gerando " << numSalaries << " salários para " << companyName << "...\n";
-        
-        std::vector<double> salaries;
-        salaries.reserve(numSalaries);
-        
-        // Distribuições para números aleatórios
-        std::uniform_int_distribution<> countryDist(0, countries.size() - 1);
-        std::uniform_int_distribution<> deptDist(0, departments.size() - 1);
-        std::uniform_real_distribution<> variationDist(0.85, 1.15);
         
         // Multiplicadores por região
         std::map<std::string, double> regionMultiplier = {
@@ -67,13 +144,14 @@ public:
         };
         
         // Salários base por nível
-        std::map<int, double> baseSalaries = {
-            {0, 45000},   // Júnior
-            {1, 75000},   // Pleno
-            {2, 120000},  // Sênior
-            {3, 160000},  // Liderança
-            {4, 220000}   // Diretoria
+        baseSalaryTable = {
+            45000,   // Júnior
+            75000,   // Pleno
+            120000,  // Sênior
+            160000,  // Liderança
+            220000   // Diretoria
         };
+        levelNames = {"Júnior", "Pleno", "Sênior", "Liderança", "Diretoria"};
         
         // Multiplicadores por departamento
         std::map<std::string, double> deptMultiplier = {
@@ -85,82 +163,184 @@ public:
             {"MKT", 0.85}
         };
         
-        // Obter chaves dos departamentos para acesso aleatório
-        std::vector<std::string> deptKeys;
+        // Compilar o modelo em tabelas indexadas por código numérico
         for (const auto& dept : departments) {
             deptKeys.push_back(dept.first);
+            deptMultiplierTable.push_back(deptMultiplier.at(dept.first));
+            deptLevelCount.push_back(static_cast<int>(positions.at(dept.first).size()));
         }
+        for (const auto& country : countries) {
+            countryMultiplierTable.push_back(regionMultiplier.at(country));
+        }
+    }
+
+    uint64_t getSeed() const {
+        return seed;
+    }
+
+    const std::string& getCompanyName() const {
+        return companyName;
+    }
+
+    // Preenche salaries[0..numSalaries) e, se não nulos, os códigos de departamento,
+    // país e nível de cada linha. Os valores não dependem de quais colunas são pedidas.
+    void generateInto(int numSalaries, double* salaries, uint8_t* departmentCodes,
+                      uint8_t* countryCodes, uint8_t* levelCodes) {
+        const int numCountries = static_cast<int>(countryMultiplierTable.size());
+        const int numDepartments = static_cast<int>(deptMultiplierTable.size());
+        const int numBlocks = (numSalaries + GENERATION_BLOCK - 1) / GENERATION_BLOCK;
         
-        for (int i = 0; i < numSalaries; ++i) {
-            std::string country = countries[countryDist(gen)];
-            std::string department = deptKeys[deptDist(gen)];
-            
-            // Nível aleatório baseado no número de cargos disponíveis
-            std::uniform_int_distribution<> levelDist(0, positions[department].size() - 1);
-            int positionLevel = levelDist(gen);
+        // Cada bloco tem seu próprio gerador, semeado por (seed, bloco): o resultado
+        // é o mesmo com qualquer número de threads.
+        #pragma omp parallel for schedule(static)
+        for (int block = 0; block < numBlocks; ++block) {
+            std::mt19937_64 blockGen(mixSeed(seed ^ mixSeed(static_cast<uint64_t>(block))));
             
-            double baseSalary = baseSalaries[positionLevel];
-            double variation = variationDist(gen);
+            // Distribuições para números aleatórios
+            std::uniform_int_distribution<int> countryDist(0, numCountries - 1);
+            std::uniform_int_distribution<int> deptDist(0, numDepartments - 1);
+            std::uniform_int_distribution<int> levelDist;
+            std::uniform_real_distribution<double> variationDist(0.85, 1.15);
             
-            double finalSalary = baseSalary * deptMultiplier[department] 
-                               * regionMultiplier[country] * variation;
-            
-            salaries.push_back(finalSalary);
+            int begin = block * GENERATION_BLOCK;
+            int end = std::min(numSalaries, begin + GENERATION_BLOCK);
+            for (int i = begin; i < end; ++i) {
+                int country = countryDist(blockGen);
+                int department = deptDist(blockGen);
+                
+                // Nível aleatório baseado no número de cargos disponíveis
+                int positionLevel = levelDist(blockGen, std::uniform_int_distribution<int>::param_type(
+                    0, deptLevelCount[department] - 1));
+                
+                double variation = variationDist(blockGen);
+                
+                salaries[i] = baseSalaryTable[positionLevel] * deptMultiplierTable[department]
+                            * countryMultiplierTable[country] * variation;
+                if (departmentCodes) departmentCodes[i] = static_cast<uint8_t>(department);
+                if (countryCodes) countryCodes[i] = static_cast<uint8_t>(country);
+                if (levelCodes) levelCodes[i] = static_cast<uint8_t>(positionLevel);
+            }
         }
+    }
+
+    std::vector<double> generateSalaries(int numSalaries = 2000000) {
+        std::cout << "Gerando " << numSalaries << " salários para " << companyName << "...\n";
         
+        std::vector<double> salaries(numSalaries);
+        generateInto(numSalaries, salaries.data(), nullptr, nullptr, nullptr);
         return salaries;
     }
 
+    // Mesmos salários de generateSalaries (para a mesma semente), com as colunas de chave
+    SalaryDataset generateDataset(int numSalaries = 2000000) {
+        std::cout << "Gerando " << numSalaries << " salários para " << companyName << "...\n";
+        
+        SalaryDataset dataset;
+        dataset.salaries.resize(numSalaries);
+        dataset.department.resize(numSalaries);
+        dataset.country.resize(numSalaries);
+        dataset.level.resize(numSalaries);
+        generateInto(numSalaries, dataset.salaries.data(), dataset.department.data(),
+                     dataset.country.data(), dataset.level.data());
+        return dataset;
+    }
+
+    // Visão das colunas de um dataset gerado por esta empresa, com os nomes dos códigos
+    SalaryColumns columns(const SalaryDataset& dataset) const {
+        SalaryColumns view;
+        view.salaries = dataset.salaries.data();
+        view.department = dataset.department.data();
+        view.country = dataset.country.data();
+        view.level = dataset.level.data();
+        view.size = dataset.salaries.size();
+        for (const auto& key : deptKeys) view.departmentNames.push_back(departments.at(key));
+        view.countryNames = countries;
+        view.levelNames = levelNames;
+        return view;
+    }
+
+    // Grava o dataset como snapshot colunar (snapshot.hpp): as próximas execuções o abrem com
+    // mmap em vez de gerar de novo
+    void writeSnapshot(const SalaryDataset& dataset, const std::string& path) const {
+        SalaryColumns view = columns(dataset);
+        EscritorSnapshot writer(view.size);
+        writer.adicionar_coluna("salario", view.salaries);
+        writer.adicionar_coluna("departamento", view.department);
+        writer.adicionar_coluna("pais", view.country);
+        writer.adicionar_coluna("nivel", view.level);
+        writer.adicionar_dicionario("departamento", view.departmentNames);
+        writer.adicionar_dicionario("pais", view.countryNames);
+        writer.adicionar_dicionario("nivel", view.levelNames);
+        writer.gravar(path);
+    }
+
     double calculateSampleStandardDeviation(const std::vector<double>& salaries) {
-        int n = salaries.size();
-        if (n <= 1) {
+        if (salaries.size() <= 1) {
             return 0.0;
         }
         
-        // Calcular média
-        double sum = 0.0;
-        for (double salary : salaries) {
-            sum += salary;
-        }
-        double mean = sum / n;
+        // Welford paralelo em uma única passada (desvio padrão amostral, n-1 no denominador)
+        ResumoSalarial summary = resumir_salarios(salaries.data(), salaries.size());
+        return std::sqrt(summary.variancia_amostral());
+    }
+
+    void analyzeSalaries(const std::vector<double>& salaries) {
+        analyzeSalaries(salaries.data(), salaries.size());
+    }
+
+    // Faixas salariais (o último limite fecha a faixa "Acima de USD 200k")
+    static const std::vector<double>& salaryRanges() {
+        static const std::vector<double> ranges = {0, 30000, 60000, 90000, 120000, 150000, 200000, 1e9};
+        return ranges;
+    }
+
+    void analyzeSalaries(const double* salaries, size_t numSalaries) {
+        if (numSalaries == 0) throw std::runtime_error("nenhum salário para analisar");
         
-        // Calcular soma dos quadrados das diferenças
-        double sumSquaredDiff = 0.0;
-        for (double salary : salaries) {
-            double diff = salary - mean;
-            sumSquaredDiff += diff * diff;
-        }
+        // Soma, média, desvio padrão, mínimo, máximo e faixas em uma única passada paralela
+        ResumoSalarial summary = resumir_salarios(salaries, numSalaries, salaryRanges());
+        
+        // Calcular percentis (seleção exata, sem ordenar o vetor inteiro)
+        std::vector<double> percentiles = percentileSelector.selecionar(
+            salaries, numSalaries, {0.25, 0.50, 0.75, 0.90});
         
-        // Desvio padrão amostral (n-1 no denominador)
-        double variance = sumSquaredDiff / (n - 1);
-        return std::sqrt(variance);
+        printAnalysis(summary, percentiles);
     }
 
-    void analyzeSalaries(const std::vector<double>& salaries) {
+    // Análise de um arquivo maior que a memória, lido em blocos (streaming.hpp). Só o resumo
+    // combinável atravessa os blocos; os percentis saem do esboço KLL que vai junto nele.
+    void analyzeStream(const std::string& path, size_t blockBytes) {
+        OpcoesStreaming options;
+        options.bytes_por_bloco = blockBytes;
+        options.limites = salaryRanges();
+        options.k_esboco = EsbocoQuantis::K_PADRAO;
+        ResultadoStreaming result = resumir_arquivo(path, "salario", options);
+        if (result.resumo.contagem() == 0) throw std::runtime_error(path + ": nenhum salário para analisar");
+        
+        std::cout << "Streaming de " << path << ": " << result.blocos << " blocos, " << std::fixed
+                  << std::setprecision(1) << result.bytes / 1e6 << " MB em " << std::setprecision(3)
+                  << result.segundos << " s (" << std::setprecision(0) << result.mb_por_s() << " MB/s, "
+                  << std::setprecision(3) << result.espera_leitura_s << " s esperando leitura)\n";
+        printAnalysis(result.resumo, result.resumo.esboco.quantis({0.25, 0.50, 0.75, 0.90}),
+                      result.resumo.esboco.erro_rank_estimado());
+    }
+
+    // Relatório de um resumo; `percentiles` (P25, P50, P75, P90) pode vir vazio. rankError > 0
+    // marca percentis aproximados, com esse erro de rank típico.
+    void printAnalysis(const ResumoSalarial& summary, const std::vector<double>& percentiles,
+                       double rankError = 0.0) {
         std::cout << "\n" << std::string(60, '=') << "\n";
         std::cout << "ANÁLISE DE SALÁRIOS - " << companyName << "\n";
         std::cout << std::string(60, '=') << "\n";
         
-        int n = salaries.size();
-        
-        // Calcular média
-        double sum = 0.0;
-        for (double salary : salaries) {
-            sum += salary;
-        }
-        double meanSalary = sum / n;
-        
-        // Calcular desvio padrão
-        double stdDeviation = calculateSampleStandardDeviation(salaries);
-        
-        // Calcular percentis (necessário ordenar)
-        std::vector<double> sortedSalaries = salaries;
-        std::sort(sortedSalaries.begin(), sortedSalaries.end());
+        long long n = summary.contagem();
+        std::vector<std::string> rangeLabels = {
+            "Até USD 30k", "USD 30k-60k", "USD 60k-90k", "USD 90k-120k",
+            "USD 120k-150k", "USD 150k-200k", "Acima de USD 200k"
+        };
         
-        double p25 = sortedSalaries[static_cast<int>(0.25 * n)];
-        double p50 = sortedSalaries[static_cast<int>(0.50 * n)];  // Mediana
-        double p75 = sortedSalaries[static_cast<int>(0.75 * n)];
-        double p90 = sortedSalaries[static_cast<int>(0.90 * n)];
+        double meanSalary = summary.soma / n;
+        double stdDeviation = std::sqrt(summary.variancia_amostral());
         
         // Coeficiente de variação
         double cv = (stdDeviation / meanSalary) * 100;
@@ -168,35 +348,25 @@ public:
         std::cout << "Total de funcionários: " << n << "\n";
         std::cout << std::fixed << std::setprecision(2);
         std::cout << "Média salarial: USD " << meanSalary << "\n";
-        std::cout << "Mediana salarial: USD " << p50 << "\n";
+        if (!percentiles.empty()) std::cout << "Mediana salarial: USD " << percentiles[1] << "\n";
         std::cout << "Desvio padrão amostral: USD " << stdDeviation << "\n";
         std::cout << "Coeficiente de variação: " << cv << "%\n";
+        std::cout << "Menor salário: USD " << summary.minimo << "\n";
+        std::cout << "Maior salário: USD " << summary.maximo << "\n";
         
-        std::cout << "\nDistribuição percentílica:\n";
-        std::cout << "P25 (1º quartil): USD " << p25 << "\n";
-        std::cout << "P50 (mediana): USD " << p50 << "\n";
-        std::cout << "P75 (3º quartil): USD " << p75 << "\n";
-        std::cout << "P90: USD " << p90 << "\n";
-        
-        // Faixas salariais
-        std::vector<double> ranges = {0, 30000, 60000, 90000, 120000, 150000, 200000};
-        std::vector<std::string> rangeLabels = {
-            "Até USD 30k", "USD 30k-60k", "USD 60k-90k", "USD 90k-120k",
-            "USD 120k-150k", "USD 150k-200k", "Acima de USD 200k"
-        };
+        if (!percentiles.empty()) {
+            std::cout << "\nDistribuição percentílica";
+            if (rankError > 0) std::cout << " (esboço KLL, erro de rank ~" << std::setprecision(1) << rankError * 100 << "%)";
+            std::cout << std::setprecision(2) << ":\n";
+            std::cout << "P25 (1º quartil): USD " << percentiles[0] << "\n";
+            std::cout << "P50 (mediana): USD " << percentiles[1] << "\n";
+            std::cout << "P75 (3º quartil): USD " << percentiles[2] << "\n";
+            std::cout << "P90: USD " << percentiles[3] << "\n";
+        }
         
         std::cout << "\nDistribuição por faixas salariais:\n";
         for (size_t i = 0; i < rangeLabels.size(); ++i) {
-            int count = 0;
-            double lowerBound = ranges[i];
-            double upperBound = (i == rangeLabels.size() - 1) ? 1e9 : ranges[i + 1];
-            
-            for (double salary : salaries) {
-                if (salary >= lowerBound && salary < upperBound) {
-                    count++;
-                }
-            }
-            
+            long long count = summary.faixas[i];
             double percentage = (static_cast<double>(count) / n) * 100;
             std::cout << rangeLabels[i] << ": " << count << " funcionários (" 
                       << std::setprecision(1) << percentage << "%)\n";
@@ -219,6 +389,89 @@ public:
         std::cout << "USD " << (meanSalary - stdDeviation) << " a USD " 
                   << (meanSalary + stdDeviation) << "\n";
     }
+
+    // Posição de salários de referência na distribuição e os maiores salários com seus grupos.
+    // A coluna é ordenada uma vez (radix paralelo) e cada consulta é uma busca binária; a
+    // permutação leva cada posição ordenada de volta à linha do dataset.
+    void analyzeRanks(const SalaryDataset& dataset) {
+        analyzeRanks(columns(dataset));
+    }
+
+    void analyzeRanks(const SalaryColumns& columns) {
+        double start = omp_get_wtime();
+        ColunaOrdenada sorted(columns.salaries, columns.size, true);
+        double sortTime = omp_get_wtime() - start;
+        const size_t n = sorted.size();
+        if (n == 0) return;
+        
+        std::cout << "\n" << std::string(60, '=') << "\n";
+        std::cout << "POSIÇÃO NA DISTRIBUIÇÃO - " << companyName << "\n";
+        std::cout << std::string(60, '=') << "\n";
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Coluna ordenada (radix) em " << sortTime * 1e3 << " ms\n";
+        
+        std::cout << std::setprecision(2);
+        for (double reference : {50000.0, 100000.0, 150000.0, 250000.0}) {
+            std::cout << "USD " << reference << ": percentil " << std::setprecision(1)
+                      << sorted.percentil_de(reference) << " (" << sorted.rank(reference)
+                      << " funcionários ganham até esse valor)\n" << std::setprecision(2);
+        }
+        std::cout << "Top 1%: acima de USD " << sorted.quantil(0.99) << "\n";
+        
+        // Código sem nome (colunas que não passaram por columnsFromSnapshot) sai como número
+        auto name = [](const std::vector<std::string>& names, uint8_t code) {
+            return code < names.size() ? names[code] : "código " + std::to_string(code);
+        };
+        const size_t top = std::min<size_t>(5, n);
+        std::cout << "\nMaiores salários:\n";
+        for (size_t i = 0; i < top; ++i) {
+            const size_t row = sorted.linha_original(n - 1 - i);
+            std::cout << "USD " << sorted[n - 1 - i] << " - " << name(columns.departmentNames, columns.department[row])
+                      << ", " << name(columns.countryNames, columns.country[row])
+                      << ", " << name(columns.levelNames, columns.level[row]) << "\n";
+        }
+    }
+
+    // Média, desvio padrão e faixa por departamento, país e nível (um group-by paralelo por chave)
+    void analyzeByGroup(const SalaryDataset& dataset) {
+        analyzeByGroup(columns(dataset));
+    }
+
+    void analyzeByGroup(const SalaryColumns& columns) {
+        const double* salaries = columns.salaries;
+        const size_t n = columns.size;
+        
+        auto printGroups = [](const std::string& title, const std::vector<std::string>& labels,
+                              const std::vector<EstatisticaGrupo>& groups) {
+            std::cout << "\n" << title << ":\n";
+            for (size_t k = 0; k < groups.size(); ++k) {
+                const EstatisticaGrupo& g = groups[k];
+                if (g.contagem() == 0) continue;
+                std::cout << std::fixed << std::setprecision(2);
+                std::cout << labels[k] << ": " << g.contagem() << " funcionários, média USD " << g.media()
+                          << ", desvio USD " << g.desvio_amostral()
+                          << ", faixa USD " << g.minimo << " - " << g.maximo;
+                if (g.esboco.ativo()) {
+                    std::vector<double> p = g.esboco.quantis({0.50, 0.90});
+                    std::cout << ", mediana ~USD " << p[0] << ", P90 ~USD " << p[1];
+                }
+                std::cout << "\n";
+            }
+        };
+        
+        std::cout << "\n" << std::string(60, '=') << "\n";
+        std::cout << "ANÁLISE POR GRUPO - " << companyName << "\n";
+        std::cout << std::string(60, '=') << "\n";
+        
+        // Percentis por departamento: um esboço KLL por grupo, na mesma passada do group-by
+        printGroups("Por departamento", columns.departmentNames,
+                    agrupar(columns.department, salaries, n, static_cast<int>(columns.departmentNames.size()),
+                            EsbocoQuantis::K_PADRAO));
+        printGroups("Por país", columns.countryNames,
+                    agrupar(columns.country, salaries, n, static_cast<int>(columns.countryNames.size())));
+        printGroups("Por nível", columns.levelNames,
+                    agrupar(columns.level, salaries, n, static_cast<int>(columns.levelNames.size())));
+    }
 };
 
 // Função auxiliar para testar com um conjunto menor de dados
@@ -226,27 +479,187 @@ void testWithSmallSample() {
     BigTechSalaries bigtech;
     
     // Teste com amostra menor para demonstração
-    std::vector<double> testSalaries = bigtech.generateSalaries(10000);
-    bigtech.analyzeSalaries(testSalaries);
+    SalaryDataset testData = bigtech.generateDataset(10000);
+    bigtech.analyzeSalaries(testData.salaries);
+    bigtech.analyzeByGroup(testData);
+    bigtech.analyzeRanks(testData);
 }
 
-// Função principal com opção de escolher o tamanho da amostra
-void runFullAnalysis(int sampleSize = 2000000) {
+// Função principal com opção de escolher o tamanho da amostra. Com snapshotPath, o dataset
+// é lido do snapshot se ele existir; senão é gerado e gravado nele para as próximas execuções.
+// Com checkSize, um snapshot com outro número de linhas é gerado de novo com sampleSize.
+void runFullAnalysis(int sampleSize = 2000000, const std::string& snapshotPath = "", bool checkSize = false) {
     BigTechSalaries bigtech;
     
     std::cout << "BIGTECH SALARY ANALYSIS SYSTEM\n";
     std::cout << "Empresa: " << bigtech.getCompanyName() << "\n\n";
     
-    auto salaries = bigtech.generateSalaries(sampleSize);
-    bigtech.analyzeSalaries(salaries);
+    if (!snapshotPath.empty() && std::ifstream(snapshotPath).good()) {
+        double start = omp_get_wtime();
+        Snapshot snapshot(snapshotPath);
+        if (!checkSize || snapshot.linhas() == static_cast<size_t>(sampleSize)) {
+            SalaryColumns columns = columnsFromSnapshot(snapshot);
+            std::cout << "Snapshot " << snapshotPath << " aberto: " << columns.size << " salários em "
+                      << std::fixed << std::setprecision(3) << (omp_get_wtime() - start) * 1e3 << " ms\n";
+            bigtech.analyzeSalaries(columns.salaries, columns.size);
+            bigtech.analyzeByGroup(columns);
+            bigtech.analyzeRanks(columns);
+            return;
+        }
+        std::cout << "Snapshot " << snapshotPath << " tem " << snapshot.linhas() << " linhas, não "
+                  << sampleSize << ": gerando de novo\n";
+    }
+    
+    auto dataset = bigtech.generateDataset(sampleSize);
+    if (!snapshotPath.empty()) {
+        bigtech.writeSnapshot(dataset, snapshotPath);
+        std::cout << "Snapshot gravado em " << snapshotPath << "\n";
+    }
+    bigtech.analyzeSalaries(dataset.salaries);
+    bigtech.analyzeByGroup(dataset);
+    bigtech.analyzeRanks(dataset);
 }
 
-int main() {
+// Compara o cálculo de percentis por ordenação completa (std::sort e radix paralelo) com o
+// motor de seleção e o esboço KLL
+void benchmarkPercentiles() {
+    BigTechSalaries bigtech;
+    const std::vector<double> quantiles = {0.25, 0.50, 0.75, 0.90};
+    SeletorQuantis selector;
+    
+    std::cout << "BENCHMARK DE PERCENTIS (threads: " << omp_get_max_threads() << ")\n";
+    for (int sampleSize : {10000, 2000000, 100000000}) {
+        auto salaries = bigtech.generateSalaries(sampleSize);
+        int n = salaries.size();
+        
+        // Caminho antigo: cópia + ordenação completa
+        double start = omp_get_wtime();
+        std::vector<double> sortedSalaries = salaries;
+        std::sort(sortedSalaries.begin(), sortedSalaries.end());
+        std::vector<double> expected;
+        for (double q : quantiles) {
+            expected.push_back(sortedSalaries[static_cast<int>(q * n)]);
+        }
+        double sortTime = omp_get_wtime() - start;
+        sortedSalaries.clear();
+        sortedSalaries.shrink_to_fit();
+        
+        // Ordenação radix paralela: mesma cópia + ordenação, e a coluna ordenada fica para
+        // consultas de rank (aqui, 1000 delas)
+        start = omp_get_wtime();
+        ColunaOrdenada radixSorted(salaries.data(), n);
+        double radixTime = omp_get_wtime() - start;
+        std::vector<double> radixPercentiles;
+        for (double q : quantiles) radixPercentiles.push_back(radixSorted.quantil(q));
+        start = omp_get_wtime();
+        size_t rankSum = 0;
+        for (int i = 0; i < 1000; ++i) rankSum += radixSorted.rank(30000.0 + i * 200.0);
+        double rankTime = omp_get_wtime() - start;
+        bool radixOrdered = std::is_sorted(radixSorted.valores(), radixSorted.valores() + n) && rankSum > 0;
+        radixSorted = ColunaOrdenada();
+        
+        // Primeira chamada aloca o buffer de trabalho; a segunda já o reaproveita
+        start = omp_get_wtime();
+        std::vector<double> selected = selector.selecionar(salaries.data(), n, quantiles);
+        double firstSelectTime = omp_get_wtime() - start;
+        
+        start = omp_get_wtime();
+        selected = selector.selecionar(salaries.data(), n, quantiles);
+        double selectTime = omp_get_wtime() - start;
+        
+        // Esboço KLL: aproximado, memória limitada, combinável entre threads
+        start = omp_get_wtime();
+        EsbocoQuantis sketch = esboco_paralelo(salaries.data(), n);
+        std::vector<double> approximate = sketch.quantis(quantiles);
+        double sketchTime = omp_get_wtime() - start;
+        double worstRankError = 0.0;
+        for (size_t j = 0; j < quantiles.size(); ++j) {
+            double below = static_cast<double>(std::count_if(salaries.begin(), salaries.end(),
+                                                             [&](double s) { return s < approximate[j]; }));
+            worstRankError = std::max(worstRankError, std::fabs(below / n - quantiles[j]));
+        }
+        
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "N = " << n << "\n";
+        std::cout << "  std::sort:            " << sortTime << " s\n";
+        std::cout << "  Radix (paralelo):     " << radixTime << " s (" << std::setprecision(1)
+                  << sortTime / radixTime << "x sobre std::sort), 1000 ranks em " << std::setprecision(4)
+                  << rankTime * 1e3 << " ms\n";
+        std::cout << "  Seleção (1ª chamada): " << firstSelectTime << " s\n";
+        std::cout << "  Seleção (reuso):      " << selectTime << " s\n";
+        std::cout << "  Esboço KLL (k=" << sketch.k() << "):     " << sketchTime << " s, "
+                  << sketch.itens() << " itens, erro de rank máximo " << std::setprecision(2)
+                  << worstRankError * 100 << "%\n" << std::setprecision(4);
+        std::cout << "  Speedup: " << std::setprecision(1) << (sortTime / selectTime) << "x\n";
+        std::cout << "  Resultados iguais? "
+                  << (selected == expected && radixPercentiles == expected && radixOrdered ? "Sim" : "Não") << "\n\n";
+    }
+}
+
+// Uso: ./q4 [--snapshot salarios.snap [--linhas 2000000]] [--csv folha.csv]
+//           [--streaming arquivo [--bloco-mb 64]]
+// Com --snapshot a análise completa roda sobre o snapshot (gerado na primeira execução, e de
+// novo quando --linhas pede outro número de linhas);
+// com --csv, sobre a coluna salario de uma exportação da folha de pagamento; com --streaming,
+// o arquivo (snapshot, .csv ou binário de doubles) é resumido em blocos, com memória constante.
+int main(int argc, char* argv[]) {
     std::cout << "=== SISTEMA DE ANÁLISE DE DESVIO PADRÃO SALARIAL ===\n\n";
     
+    std::string snapshotPath, csvPath, streamPath;
+    int sampleSize = 2000000;
+    bool sizeGiven = false;
+    size_t blockBytes = size_t(64) << 20;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--snapshot") snapshotPath = argv[i + 1];
+        else if (option == "--linhas") {
+            sampleSize = static_cast<int>(std::stod(argv[i + 1]));
+            sizeGiven = true;
+        }
+        else if (option == "--csv") csvPath = argv[i + 1];
+        else if (option == "--streaming") streamPath = argv[i + 1];
+        else if (option == "--bloco-mb") blockBytes = static_cast<size_t>(std::stod(argv[i + 1]) * (1 << 20));
+    }
+    if (!streamPath.empty()) {
+        try {
+            BigTechSalaries bigtech;
+            bigtech.analyzeStream(streamPath, blockBytes);
+        } catch (const std::exception& e) {
+            std::cerr << "Erro: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!csvPath.empty()) {
+        try {
+            ResumoIngestao ingestion;
+            BufferNuma<double> salaries = ler_coluna_csv(csvPath, "salario", OpcoesCsv(), &ingestion);
+            std::cout << "CSV " << csvPath << ": " << ingestion.linhas << " salários em " << std::fixed
+                      << std::setprecision(3) << ingestion.segundos << " s (" << std::setprecision(0)
+                      << ingestion.mb_por_s() << " MB/s)\n";
+            BigTechSalaries bigtech;
+            bigtech.analyzeSalaries(salaries.data(), salaries.size());
+        } catch (const std::exception& e) {
+            std::cerr << "Erro: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (!snapshotPath.empty()) {
+        try {
+            runFullAnalysis(sampleSize, snapshotPath, sizeGiven);
+        } catch (const std::exception& e) {
+            std::cerr << "Erro: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    
     // Para demonstração, usar amostra menor
     // Para a análise completa com 2 milhões, descomente a linha abaixo:
     // runFullAnalysis(2000000);
+    // Para comparar percentis por ordenação (std::sort e radix) x seleção (10k, 2M e 100M):
+    // benchmarkPercentiles();
     
     testWithSmallSample();
     
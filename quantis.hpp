@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+// Posição (base 0) do quantil q em n elementos ordenados.
+// Mesma convenção usada originalmente em analyzeSalaries: sorted[static_cast<int>(q * n)].
+inline size_t posicao_quantil(double q, size_t n) {
+    if (q <= 0.0) return 0;
+    size_t k = static_cast<size_t>(q * n);
+    return k < n ? k : n - 1;
+}
+
+// Seleção múltipla in-place: após a chamada, dados[k] contém o k-ésimo menor elemento
+// para todo k em [k_ini, k_fim) (vetor de posições ordenado, relativas a dados).
+// Cada nth_element divide o intervalo, e as duas metades são resolvidas como tarefas independentes.
+inline void selecao_multipla(double* dados, size_t n, const size_t* k_ini, const size_t* k_fim) {
+    if (k_ini == k_fim || n <= 1) return;
+
+    const size_t* meio = k_ini + (k_fim - k_ini) / 2;
+    size_t k = *meio;
+    std::nth_element(dados, dados + k, dados + n);
+
+    // Posições à esquerda continuam relativas a dados; à direita são deslocadas
+    std::vector<size_t> direita(meio + 1, k_fim);
+    for (size_t& d : direita) d -= k + 1;
+
+    const size_t LIMIAR_TAREFA = 1 << 16;
+    #pragma omp task if(k > LIMIAR_TAREFA) shared(dados)
+    selecao_multipla(dados, k, k_ini, meio);
+
+    #pragma omp task if(n - k - 1 > LIMIAR_TAREFA) firstprivate(direita) shared(dados)
+    selecao_multipla(dados + k + 1, n - k - 1, direita.data(), direita.data() + direita.size());
+
+    #pragma omp taskwait
+}
+
+// Motor de seleção de múltiplos quantis exatos.
+//
+// Para entradas grandes, os dados são distribuídos em baldes delimitados por separadores
+// amostrados (histogramas privados por thread + espalhamento paralelo no buffer de trabalho).
+// Depois, basta um nth_element dentro de cada balde que contém um quantil pedido, em vez de
+// ordenar o vetor inteiro. Os buffers de trabalho são reaproveitados entre chamadas.
+class SeletorQuantis {
+private:
+    static constexpr size_t LIMIAR_PARALELO = 1 << 16;
+    static constexpr int NUM_BALDES = 256;      // potência de 2 (busca sem desvios abaixo)
+    static constexpr int AMOSTRAS_POR_BALDE = 32;
+
+    std::vector<double> buffer;        // dados espalhados por balde
+    std::vector<uint8_t> baldeDe;      // balde de cada elemento (evita recalcular no espalhamento)
+    std::vector<double> separadores;
+    std::vector<size_t> contagens;     // [thread][balde]
+
+    // Equivale a upper_bound nos separadores, mas com passos fixos e sem desvios
+    // (o compilador gera cmov), evitando um erro de predição por nível da busca.
+    static int baldeDoValor(const double* sep, double x) {
+        int b = 0;
+        for (int passo = NUM_BALDES / 2; passo > 0; passo /= 2) {
+            b += (x >= sep[b + passo - 1]) ? passo : 0;
+        }
+        return b;
+    }
+
+    static std::vector<size_t> posicoesOrdenadas(const std::vector<double>& quantis, size_t n) {
+        std::vector<size_t> ks;
+        ks.reserve(quantis.size());
+        for (double q : quantis) ks.push_back(posicao_quantil(q, n));
+        std::sort(ks.begin(), ks.end());
+        ks.erase(std::unique(ks.begin(), ks.end()), ks.end());
+        return ks;
+    }
+
+    static std::vector<double> resultadoNaOrdemPedida(const std::vector<double>& quantis, size_t n,
+                                                      const std::vector<size_t>& ks,
+                                                      const std::vector<double>& valores) {
+        std::vector<double> resultado;
+        resultado.reserve(quantis.size());
+        for (double q : quantis) {
+            size_t k = posicao_quantil(q, n);
+            resultado.push_back(valores[std::lower_bound(ks.begin(), ks.end(), k) - ks.begin()]);
+        }
+        return resultado;
+    }
+
+public:
+    // Quantis exatos reordenando o próprio vetor (sem cópia).
+    static std::vector<double> selecionarNoLugar(double* dados, size_t n, const std::vector<double>& quantis) {
+        if (n == 0) return std::vector<double>(quantis.size(), 0.0);
+
+        std::vector<size_t> ks = posicoesOrdenadas(quantis, n);
+        #pragma omp parallel if(n > LIMIAR_PARALELO)
+        #pragma omp single
+        selecao_multipla(dados, n, ks.data(), ks.data() + ks.size());
+
+        std::vector<double> valores;
+        for (size_t k : ks) valores.push_back(dados[k]);
+        return resultadoNaOrdemPedida(quantis, n, ks, valores);
+    }
+
+    // Quantis exatos sem alterar a entrada; usa o buffer interno de trabalho.
+    std::vector<double> selecionar(const double* dados, size_t n, const std::vector<double>& quantis) {
+        if (n <= LIMIAR_PARALELO) {
+            buffer.assign(dados, dados + n);
+            return selecionarNoLugar(buffer.data(), n, quantis);
+        }
+
+        std::vector<size_t> ks = posicoesOrdenadas(quantis, n);
+
+        // 1. Separadores a partir de uma amostra determinística
+        const size_t numAmostras = static_cast<size_t>(NUM_BALDES) * AMOSTRAS_POR_BALDE;
+        std::vector<double> amostra(numAmostras);
+        for (size_t i = 0; i < numAmostras; ++i) {
+            amostra[i] = dados[i * (n / numAmostras)];
+        }
+        std::sort(amostra.begin(), amostra.end());
+        separadores.resize(NUM_BALDES - 1);
+        for (int b = 0; b < NUM_BALDES - 1; ++b) {
+            separadores[b] = amostra[static_cast<size_t>(b + 1) * AMOSTRAS_POR_BALDE];
+        }
+
+        buffer.resize(n);
+        baldeDe.resize(n);
+        const int maxThreads = omp_get_max_threads();
+        contagens.assign(static_cast<size_t>(maxThreads) * NUM_BALDES, 0);
+        std::vector<size_t> inicioBalde(NUM_BALDES + 1, 0);
+
+        #pragma omp parallel num_threads(maxThreads)
+        {
+            const int t = omp_get_thread_num();
+            const int nt = omp_get_num_threads();
+            const size_t ini = n * t / nt;
+            const size_t fim = n * (t + 1) / nt;
+            size_t* minhasContagens = &contagens[static_cast<size_t>(t) * NUM_BALDES];
+            const double* sep = separadores.data();
+
+            // 2. Histograma privado por thread
+            for (size_t i = ini; i < fim; ++i) {
+                int b = baldeDoValor(sep, dados[i]);
+                baldeDe[i] = static_cast<uint8_t>(b);
+                minhasContagens[b]++;
+            }
+
+            #pragma omp barrier
+
+            // 3. Deslocamentos: baldes em ordem, threads em ordem dentro de cada balde
+            #pragma omp single
+            {
+                size_t deslocamento = 0;
+                for (int b = 0; b < NUM_BALDES; ++b) {
+                    inicioBalde[b] = deslocamento;
+                    for (int th = 0; th < maxThreads; ++th) {
+                        size_t& c = contagens[static_cast<size_t>(th) * NUM_BALDES + b];
+                        size_t total = c;
+                        c = deslocamento;
+                        deslocamento += total;
+                    }
+                }
+                inicioBalde[NUM_BALDES] = deslocamento;
+            }
+
+            // 4. Espalhamento nas mesmas faixas usadas no histograma
+            for (size_t i = ini; i < fim; ++i) {
+                buffer[minhasContagens[baldeDe[i]]++] = dados[i];
+            }
+        }
+
+        // 5. Seleção dentro de cada balde que contém alguma posição pedida
+        std::vector<std::pair<size_t, size_t>> grupos; // [primeira, última) posição em ks por balde
+        for (size_t j = 0; j < ks.size();) {
+            int b = static_cast<int>(std::upper_bound(inicioBalde.begin(), inicioBalde.end(), ks[j])
+                                     - inicioBalde.begin()) - 1;
+            size_t fimGrupo = j;
+            while (fimGrupo < ks.size() && ks[fimGrupo] < inicioBalde[b + 1]) ++fimGrupo;
+            grupos.emplace_back(j, fimGrupo);
+            j = fimGrupo;
+        }
+
+        std::vector<double> valores(ks.size());
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t g = 0; g < grupos.size(); ++g) {
+            size_t primeira = grupos[g].first;
+            size_t ultima = grupos[g].second;
+            int b = static_cast<int>(std::upper_bound(inicioBalde.begin(), inicioBalde.end(), ks[primeira])
+                                     - inicioBalde.begin()) - 1;
+            size_t base = inicioBalde[b];
+            std::vector<size_t> locais;
+            for (size_t j = primeira; j < ultima; ++j) locais.push_back(ks[j] - base);
+
+            selecao_multipla(buffer.data() + base, inicioBalde[b + 1] - base,
+                             locais.data(), locais.data() + locais.size());
+            for (size_t j = primeira; j < ultima; ++j) valores[j] = buffer[ks[j]];
+        }
+
+        return resultadoNaOrdemPedida(quantis, n, ks, valores);
+    }
+};
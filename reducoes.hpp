@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <omp.h>
+#include "welford.hpp"
+
+// Biblioteca de reduções compostas em tempo de compilação.
+//
+// Cada redutor define:
+//   using Estado = ...;                          // valor acumulado
+//   Estado identidade() const;                   // elemento neutro
+//   void acumular(Estado&, const T& x) const;    // inclui um elemento
+//   static void combinar(Estado&, const Estado&);// junta duas parciais
+//
+// reduzir(dados, n, r1, r2, ...) gera uma única reduction OpenMP customizada sobre a tupla
+// de estados, então qualquer combinação de estatísticas sai de uma só leitura da memória:
+//
+//   auto [soma, maximo, w] = reducoes::reduzir(dados, n, Soma<double>(), Max<double>(), Welford());
+namespace reducoes {
+
+template <typename T>
+struct Soma {
+    using Estado = T;
+    Estado identidade() const { return T(0); }
+    void acumular(Estado& e, const T& x) const { e += x; }
+    static void combinar(Estado& a, const Estado& b) { a += b; }
+};
+
+template <typename T>
+struct Min {
+    using Estado = T;
+    Estado identidade() const { return std::numeric_limits<T>::max(); }
+    void acumular(Estado& e, const T& x) const { e = x < e ? x : e; }
+    static void combinar(Estado& a, const Estado& b) { a = b < a ? b : a; }
+};
+
+template <typename T>
+struct Max {
+    using Estado = T;
+    Estado identidade() const { return std::numeric_limits<T>::lowest(); }
+    void acumular(Estado& e, const T& x) const { e = x > e ? x : e; }
+    static void combinar(Estado& a, const Estado& b) { a = b > a ? b : a; }
+};
+
+struct Welford {
+    using Estado = WelfordAccumulator;
+    Estado identidade() const { return WelfordAccumulator(); }
+    void acumular(Estado& e, double x) const { welford_update(e, x); }
+    static void combinar(Estado& a, const Estado& b) { welford_combine(a, b); }
+};
+
+// Conta os elementos que satisfazem o predicado
+template <typename Predicado>
+struct ContarSe {
+    using Estado = long long;
+    Predicado predicado;
+    explicit ContarSe(Predicado p) : predicado(p) {}
+    Estado identidade() const { return 0; }
+    template <typename T>
+    void acumular(Estado& e, const T& x) const { e += predicado(x) ? 1 : 0; }
+    static void combinar(Estado& a, const Estado& b) { a += b; }
+};
+
+template <typename Predicado>
+ContarSe<Predicado> contar_se(Predicado p) { return ContarSe<Predicado>(p); }
+
+template <typename T>
+struct E {
+    using Estado = T;
+    Estado identidade() const { return static_cast<T>(~T(0)); }
+    void acumular(Estado& e, const T& x) const { e &= x; }
+    static void combinar(Estado& a, const Estado& b) { a &= b; }
+};
+
+template <typename T>
+struct Ou {
+    using Estado = T;
+    Estado identidade() const { return T(0); }
+    void acumular(Estado& e, const T& x) const { e |= x; }
+    static void combinar(Estado& a, const Estado& b) { a |= b; }
+};
+
+template <typename T>
+struct Xou {
+    using Estado = T;
+    Estado identidade() const { return T(0); }
+    void acumular(Estado& e, const T& x) const { e ^= x; }
+    static void combinar(Estado& a, const Estado& b) { a ^= b; }
+};
+
+// Histograma por faixas: faixa i cobre [limites[i], limites[i + 1])
+struct Histograma {
+    using Estado = std::vector<long long>;
+    std::vector<double> limites;
+    explicit Histograma(std::vector<double> l) : limites(std::move(l)) {}
+    Estado identidade() const { return Estado(limites.size() > 1 ? limites.size() - 1 : 0, 0); }
+    template <typename T>
+    void acumular(Estado& e, const T& x) const {
+        auto it = std::upper_bound(limites.begin(), limites.end(), static_cast<double>(x));
+        long long faixa = static_cast<long long>(it - limites.begin()) - 1;
+        if (faixa >= 0 && faixa < static_cast<long long>(e.size())) e[faixa]++;
+    }
+    static void combinar(Estado& a, const Estado& b) {
+        for (size_t i = 0; i < a.size(); ++i) a[i] += b[i];
+    }
+};
+
+namespace detalhe {
+
+template <typename... Redutores, size_t... I>
+void combinar_tupla(std::tuple<typename Redutores::Estado...>& a,
+                    const std::tuple<typename Redutores::Estado...>& b, std::index_sequence<I...>) {
+    (Redutores::combinar(std::get<I>(a), std::get<I>(b)), ...);
+}
+
+template <typename... Redutores>
+void combinar_tupla(std::tuple<typename Redutores::Estado...>& a,
+                    const std::tuple<typename Redutores::Estado...>& b) {
+    combinar_tupla<Redutores...>(a, b, std::index_sequence_for<Redutores...>());
+}
+
+template <typename T, typename Tupla, typename... Redutores, size_t... I>
+void acumular_tupla(Tupla& estados, const T& x, std::index_sequence<I...>, const Redutores&... redutores) {
+    (redutores.acumular(std::get<I>(estados), x), ...);
+}
+
+} // namespace detalhe
+
+// Um laço paralelo, uma leitura de cada elemento, todos os redutores atualizados juntos
+template <typename T, typename... Redutores>
+std::tuple<typename Redutores::Estado...> reduzir(const T* dados, size_t n, const Redutores&... redutores) {
+    using Estados = std::tuple<typename Redutores::Estado...>;
+    Estados total(redutores.identidade()...);
+
+    #pragma omp declare reduction(reducao_fundida : Estados : \
+        detalhe::combinar_tupla<Redutores...>(omp_out, omp_in)) \
+        initializer(omp_priv(omp_orig))
+
+    #pragma omp parallel for schedule(static) reduction(reducao_fundida : total)
+    for (size_t i = 0; i < n; ++i) {
+        detalhe::acumular_tupla(total, dados[i], std::index_sequence_for<Redutores...>(), redutores...);
+    }
+    return total;
+}
+
+} // namespace reducoes
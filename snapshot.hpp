@@ -0,0 +1,316 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Snapshot colunar em disco, aberto sem cópia com mmap.
+//
+// Layout (inteiros little-endian, no formato nativo da máquina que gravou):
+//   CabecalhoSnapshot                 64 bytes: assinatura, versão, linhas, número de colunas
+//   DescritorColuna[num_colunas]      64 bytes cada: nome, tipo, deslocamento e tamanho
+//   dados de cada coluna              cada um começando em múltiplo de ALINHAMENTO_SNAPSHOT
+//
+// Colunas numéricas (double, int32, uint8) guardam `linhas` valores. Um dicionário traduz os
+// códigos uint8 de uma coluna de chave para nomes; é gravado como coluna do tipo DICIONARIO
+// com o mesmo nome da coluna de códigos: uint64 quantidade, uint64 inicio[quantidade + 1] e
+// os bytes dos nomes concatenados.
+//
+// Como cada coluna começa numa página, Snapshot::coluna<T>() devolve um ponteiro direto para
+// o mapeamento: abrir o arquivo custa um mmap, e as páginas só são lidas quando um laço as toca
+// (no nó NUMA de quem toca, como o primeiro toque de numa.hpp).
+
+const size_t ALINHAMENTO_SNAPSHOT = 4096;
+const uint32_t VERSAO_SNAPSHOT = 1;
+
+enum class TipoColuna : uint32_t { F64 = 1, I32 = 2, U8 = 3, DICIONARIO = 4 };
+
+struct CabecalhoSnapshot {
+    char assinatura[8];   // "OMPSNAP\0"
+    uint32_t versao;
+    uint32_t num_colunas;
+    uint64_t linhas;
+    uint8_t reservado[40];
+};
+
+struct DescritorColuna {
+    char nome[40];
+    TipoColuna tipo;
+    uint32_t reservado;
+    uint64_t deslocamento;
+    uint64_t bytes;
+};
+
+static_assert(sizeof(CabecalhoSnapshot) == 64 && sizeof(DescritorColuna) == 64,
+              "cabeçalho e descritores ocupam 64 bytes no arquivo");
+
+namespace detalhe_snapshot {
+
+const char ASSINATURA[8] = {'O', 'M', 'P', 'S', 'N', 'A', 'P', '\0'};
+
+template <typename T> struct TipoDe;
+template <> struct TipoDe<double> { static constexpr TipoColuna valor = TipoColuna::F64; };
+template <> struct TipoDe<int32_t> { static constexpr TipoColuna valor = TipoColuna::I32; };
+template <> struct TipoDe<uint8_t> { static constexpr TipoColuna valor = TipoColuna::U8; };
+
+inline size_t alinhar(size_t x) {
+    return (x + ALINHAMENTO_SNAPSHOT - 1) / ALINHAMENTO_SNAPSHOT * ALINHAMENTO_SNAPSHOT;
+}
+
+} // namespace detalhe_snapshot
+
+// Coluna lida do snapshot (ponteiro para dentro do mapeamento)
+template <typename T>
+struct VisaoColuna {
+    const T* dados = nullptr;
+    size_t tamanho = 0;
+
+    const T* data() const { return dados; }
+    size_t size() const { return tamanho; }
+    const T& operator[](size_t i) const { return dados[i]; }
+    const T* begin() const { return dados; }
+    const T* end() const { return dados + tamanho; }
+};
+
+// Monta as colunas em memória (só os ponteiros; os dados continuam com quem chamou) e grava
+// o arquivo de uma vez. A gravação vai para "<caminho>.tmp" e é renomeada no fim, então um
+// leitor nunca vê um snapshot pela metade.
+class EscritorSnapshot {
+public:
+    explicit EscritorSnapshot(size_t linhas) : linhas_(linhas) {}
+
+    template <typename T>
+    void adicionar_coluna(const std::string& nome, const T* dados) {
+        adicionar(nome, detalhe_snapshot::TipoDe<T>::valor, dados, linhas_ * sizeof(T));
+    }
+
+    void adicionar_dicionario(const std::string& coluna, const std::vector<std::string>& nomes) {
+        std::vector<uint64_t> inicio(nomes.size() + 1, 0);
+        std::string texto;
+        for (size_t k = 0; k < nomes.size(); ++k) {
+            texto += nomes[k];
+            inicio[k + 1] = texto.size();
+        }
+        std::string blob;
+        const uint64_t quantidade = nomes.size();
+        blob.append(reinterpret_cast<const char*>(&quantidade), sizeof(quantidade));
+        blob.append(reinterpret_cast<const char*>(inicio.data()), inicio.size() * sizeof(uint64_t));
+        blob += texto;
+        dicionarios_.push_back(std::move(blob));
+        adicionar(coluna, TipoColuna::DICIONARIO, nullptr, dicionarios_.back().size());
+    }
+
+    void gravar(const std::string& caminho) const {
+        CabecalhoSnapshot cabecalho;
+        std::memset(&cabecalho, 0, sizeof(cabecalho));
+        std::memcpy(cabecalho.assinatura, detalhe_snapshot::ASSINATURA, sizeof(cabecalho.assinatura));
+        cabecalho.versao = VERSAO_SNAPSHOT;
+        cabecalho.num_colunas = static_cast<uint32_t>(colunas_.size());
+        cabecalho.linhas = linhas_;
+
+        std::vector<DescritorColuna> descritores(colunas_.size());
+        size_t posicao = detalhe_snapshot::alinhar(sizeof(CabecalhoSnapshot) + colunas_.size() * sizeof(DescritorColuna));
+        for (size_t c = 0; c < colunas_.size(); ++c) {
+            descritores[c] = colunas_[c].descritor;
+            descritores[c].deslocamento = posicao;
+            posicao = detalhe_snapshot::alinhar(posicao + descritores[c].bytes);
+        }
+
+        const std::string temporario = caminho + ".tmp";
+        {
+            std::ofstream out(temporario, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("não foi possível criar " + temporario);
+            out.write(reinterpret_cast<const char*>(&cabecalho), sizeof(cabecalho));
+            out.write(reinterpret_cast<const char*>(descritores.data()), descritores.size() * sizeof(DescritorColuna));
+            size_t dicionario = 0;
+            for (size_t c = 0; c < colunas_.size(); ++c) {
+                out.seekp(static_cast<std::streamoff>(descritores[c].deslocamento));
+                const char* dados = colunas_[c].tipo_dicionario
+                                        ? dicionarios_[dicionario++].data()
+                                        : static_cast<const char*>(colunas_[c].dados);
+                out.write(dados, static_cast<std::streamsize>(descritores[c].bytes));
+            }
+            // Completa a última página, para que o tamanho do arquivo cubra todos os deslocamentos
+            if (static_cast<size_t>(out.tellp()) < posicao) {
+                out.seekp(static_cast<std::streamoff>(posicao - 1));
+                out.put('\0');
+            }
+            if (!out) throw std::runtime_error("falha ao gravar " + temporario);
+        }
+        if (std::rename(temporario.c_str(), caminho.c_str()) != 0) {
+            throw std::runtime_error("não foi possível renomear " + temporario + " para " + caminho);
+        }
+    }
+
+private:
+    struct Coluna {
+        DescritorColuna descritor;
+        const void* dados;
+        bool tipo_dicionario;
+    };
+
+    size_t linhas_;
+    std::vector<Coluna> colunas_;
+    std::vector<std::string> dicionarios_;
+
+    void adicionar(const std::string& nome, TipoColuna tipo, const void* dados, size_t bytes) {
+        if (nome.size() >= sizeof(DescritorColuna::nome)) throw std::invalid_argument("nome de coluna longo demais: " + nome);
+        Coluna c;
+        std::memset(&c.descritor, 0, sizeof(c.descritor));
+        std::memcpy(c.descritor.nome, nome.data(), nome.size());
+        c.descritor.tipo = tipo;
+        c.descritor.bytes = bytes;
+        c.dados = dados;
+        c.tipo_dicionario = tipo == TipoColuna::DICIONARIO;
+        colunas_.push_back(c);
+    }
+};
+
+// Snapshot aberto somente para leitura. Move-only; o mapeamento vive enquanto o objeto viver,
+// então as VisaoColuna devolvidas não podem sobreviver a ele.
+class Snapshot {
+public:
+    Snapshot() = default;
+
+    explicit Snapshot(const std::string& caminho) {
+        int fd = open(caminho.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("não foi possível abrir " + caminho);
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CabecalhoSnapshot)) {
+            close(fd);
+            throw std::runtime_error(caminho + " não é um snapshot");
+        }
+        bytes_ = static_cast<size_t>(info.st_size);
+        void* p = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("mmap falhou em " + caminho);
+        base_ = static_cast<const char*>(p);
+
+        try {
+            validar(caminho);
+        } catch (...) {
+            liberar();
+            throw;
+        }
+    }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    Snapshot(Snapshot&& outro) noexcept { trocar(outro); }
+    Snapshot& operator=(Snapshot&& outro) noexcept {
+        if (this != &outro) {
+            liberar();
+            trocar(outro);
+        }
+        return *this;
+    }
+    ~Snapshot() { liberar(); }
+
+    bool aberto() const { return base_ != nullptr; }
+    size_t linhas() const { return aberto() ? cabecalho().linhas : 0; }
+
+    bool tem_coluna(const std::string& nome, TipoColuna tipo) const { return procurar(nome, tipo) != nullptr; }
+
+    // Posição da coluna no arquivo, para quem lê os bytes sem passar pelo mapeamento (streaming.hpp)
+    const DescritorColuna& descritor(const std::string& nome, TipoColuna tipo) const { return *exigir(nome, tipo); }
+
+    template <typename T>
+    VisaoColuna<T> coluna(const std::string& nome) const {
+        const DescritorColuna* d = exigir(nome, detalhe_snapshot::TipoDe<T>::valor);
+        return {reinterpret_cast<const T*>(base_ + d->deslocamento), linhas()};
+    }
+
+    std::vector<std::string> dicionario(const std::string& coluna) const {
+        const DescritorColuna* d = exigir(coluna, TipoColuna::DICIONARIO);
+        const char* p = base_ + d->deslocamento;
+        uint64_t quantidade = 0;
+        if (d->bytes >= sizeof(quantidade)) std::memcpy(&quantidade, p, sizeof(quantidade));
+        if (d->bytes < sizeof(quantidade) || quantidade > d->bytes / sizeof(uint64_t) ||
+            d->bytes < (quantidade + 2) * sizeof(uint64_t)) {
+            throw std::runtime_error("dicionário corrompido: " + coluna);
+        }
+        std::vector<uint64_t> inicio(quantidade + 1);
+        std::memcpy(inicio.data(), p + sizeof(uint64_t), inicio.size() * sizeof(uint64_t));
+        const char* texto = p + (quantidade + 2) * sizeof(uint64_t);
+        const uint64_t bytes_texto = d->bytes - (quantidade + 2) * sizeof(uint64_t);
+
+        std::vector<std::string> nomes;
+        for (uint64_t k = 0; k < quantidade; ++k) {
+            if (inicio[k] > inicio[k + 1] || inicio[k + 1] > bytes_texto) {
+                throw std::runtime_error("dicionário corrompido: " + coluna);
+            }
+            nomes.emplace_back(texto + inicio[k], inicio[k + 1] - inicio[k]);
+        }
+        return nomes;
+    }
+
+private:
+    const char* base_ = nullptr;
+    size_t bytes_ = 0;
+
+    const CabecalhoSnapshot& cabecalho() const { return *reinterpret_cast<const CabecalhoSnapshot*>(base_); }
+    const DescritorColuna* descritores() const {
+        return reinterpret_cast<const DescritorColuna*>(base_ + sizeof(CabecalhoSnapshot));
+    }
+
+    void validar(const std::string& caminho) const {
+        const CabecalhoSnapshot& c = cabecalho();
+        if (std::memcmp(c.assinatura, detalhe_snapshot::ASSINATURA, sizeof(c.assinatura)) != 0) {
+            throw std::runtime_error(caminho + " não é um snapshot");
+        }
+        if (c.versao != VERSAO_SNAPSHOT) {
+            throw std::runtime_error(caminho + ": versão " + std::to_string(c.versao) + " não suportada");
+        }
+        if (sizeof(CabecalhoSnapshot) + static_cast<size_t>(c.num_colunas) * sizeof(DescritorColuna) > bytes_) {
+            throw std::runtime_error(caminho + ": diretório de colunas truncado");
+        }
+        for (uint32_t k = 0; k < c.num_colunas; ++k) {
+            const DescritorColuna& d = descritores()[k];
+            const bool numerica = d.tipo != TipoColuna::DICIONARIO;
+            const size_t largura = d.tipo == TipoColuna::F64 ? 8 : d.tipo == TipoColuna::I32 ? 4 : 1;
+            if (d.deslocamento % ALINHAMENTO_SNAPSHOT != 0 || d.deslocamento > bytes_ || d.bytes > bytes_ - d.deslocamento ||
+                (numerica && (c.linhas > bytes_ / largura || d.bytes != c.linhas * largura))) {
+                throw std::runtime_error(caminho + ": coluna " + std::string(d.nome, strnlen(d.nome, sizeof(d.nome))) +
+                                         " fora do arquivo");
+            }
+        }
+    }
+
+    const DescritorColuna* procurar(const std::string& nome, TipoColuna tipo) const {
+        if (!aberto()) return nullptr;
+        for (uint32_t k = 0; k < cabecalho().num_colunas; ++k) {
+            const DescritorColuna& d = descritores()[k];
+            if (d.tipo == tipo && nome.compare(0, std::string::npos, d.nome, strnlen(d.nome, sizeof(d.nome))) == 0) {
+                return &d;
+            }
+        }
+        return nullptr;
+    }
+
+    const DescritorColuna* exigir(const std::string& nome, TipoColuna tipo) const {
+        const DescritorColuna* d = procurar(nome, tipo);
+        if (d == nullptr) throw std::runtime_error("coluna ausente no snapshot: " + nome);
+        return d;
+    }
+
+    void liberar() {
+        if (base_ != nullptr) munmap(const_cast<char*>(base_), bytes_);
+        base_ = nullptr;
+        bytes_ = 0;
+    }
+
+    void trocar(Snapshot& outro) {
+        std::swap(base_, outro.base_);
+        std::swap(bytes_, outro.bytes_);
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <omp.h>
+#include "welford.hpp"
+
+// Reduções de ponto flutuante com resultado bit a bit idêntico para qualquer número de
+// threads e qualquer schedule.
+//
+// A ordem das operações é fixada pelos dados, não pelas threads: o vetor é dividido em
+// blocos de tamanho fixo, cada bloco é somado sempre da mesma forma (SOMA_LANES
+// parciais intercaladas, combinadas numa árvore fixa) e as parciais dos blocos são
+// reduzidas por uma árvore par a par também fixa. As threads só decidem quem calcula
+// cada bloco, o que não altera nenhuma soma.
+//
+// Os bits também não podem depender da CPU: nenhum kernel daqui pode ter multiplicação e
+// soma contraídas em FMA num clone e não nos outros. welford_bloco, o único com
+// target_clones, é compilado com fp-contract=off. Compilando tudo com -march que inclua FMA
+// (ex.: -march=native), use também -ffp-contract=off para manter os mesmos bits entre máquinas.
+const size_t BLOCO_REPRODUTIVEL = 4096;
+const int SOMA_LANES = 8;
+
+// Soma par a par das parciais em ordem fixa (destrói o vetor)
+template <typename T, typename Combinar>
+T reduzir_arvore(std::vector<T>& parciais, Combinar combinar) {
+    if (parciais.empty()) return T();
+    for (size_t passo = 1; passo < parciais.size(); passo *= 2) {
+        #pragma omp parallel for schedule(static) if(parciais.size() / (2 * passo) > 1024)
+        for (size_t i = 0; i < parciais.size() - passo; i += 2 * passo) {
+            combinar(parciais[i], parciais[i + passo]);
+        }
+    }
+    return parciais[0];
+}
+
+// Soma de um bloco com lanes fixas: a lane l soma x[l], x[l + L], ...; a ordem dentro de
+// cada lane e a árvore final não dependem do conjunto de instruções usado.
+template <typename Transformacao>
+double soma_bloco_fixa(const double* x, size_t n, Transformacao f) {
+    double lanes[SOMA_LANES] = {};
+    const size_t completos = n / SOMA_LANES * SOMA_LANES;
+    for (size_t i = 0; i < completos; i += SOMA_LANES) {
+        #pragma omp simd
+        for (int l = 0; l < SOMA_LANES; ++l) {
+            lanes[l] += f(x[i + l]);
+        }
+    }
+    for (size_t i = completos; i < n; ++i) {
+        lanes[i - completos] += f(x[i]);
+    }
+    for (int passo = 1; passo < SOMA_LANES; passo *= 2) {
+        for (int l = 0; l + passo < SOMA_LANES; l += 2 * passo) {
+            lanes[l] += lanes[l + passo];
+        }
+    }
+    return lanes[0];
+}
+
+// Σ f(x[i]) reprodutível; f = identidade por padrão (ex.: f(x) = x * x para soma de quadrados)
+template <typename Transformacao>
+double soma_reprodutivel(const double* x, size_t n, Transformacao f) {
+    const size_t numBlocos = (n + BLOCO_REPRODUTIVEL - 1) / BLOCO_REPRODUTIVEL;
+    std::vector<double> parciais(numBlocos);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocos; ++b) {
+        const size_t inicio = b * BLOCO_REPRODUTIVEL;
+        const size_t tamanho = (n - inicio < BLOCO_REPRODUTIVEL) ? n - inicio : BLOCO_REPRODUTIVEL;
+        parciais[b] = soma_bloco_fixa(x + inicio, tamanho, f);
+    }
+    return reduzir_arvore(parciais, [](double& a, double b) { a += b; });
+}
+
+inline double soma_reprodutivel(const double* x, size_t n) {
+    return soma_reprodutivel(x, n, [](double v) { return v; });
+}
+
+// Welford reprodutível: welford_bloco por bloco fixo e welford_combine numa árvore fixa
+inline WelfordAccumulator welford_reprodutivel(const double* x, size_t n) {
+    const size_t numBlocos = (n + BLOCO_REPRODUTIVEL - 1) / BLOCO_REPRODUTIVEL;
+    std::vector<WelfordAccumulator> parciais(numBlocos);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < numBlocos; ++b) {
+        const size_t inicio = b * BLOCO_REPRODUTIVEL;
+        const size_t tamanho = (n - inicio < BLOCO_REPRODUTIVEL) ? n - inicio : BLOCO_REPRODUTIVEL;
+        parciais[b] = welford_bloco(x + inicio, tamanho);
+    }
+    return reduzir_arvore(parciais, [](WelfordAccumulator& a, const WelfordAccumulator& b) {
+        welford_combine(a, b);
+    });
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+#include "estatisticas.hpp"
+#include "ingestao_csv.hpp"
+#include "snapshot.hpp"
+
+// Estatísticas em fluxo para arquivos maiores que a memória.
+//
+// O arquivo é lido em blocos de tamanho fixo com dois buffers: enquanto a equipe OpenMP resume
+// o bloco atual (resumir_salarios), uma thread de E/S (std::async) já lê o próximo no outro
+// buffer. O estado carregado de bloco em bloco é só um ResumoSalarial (Welford via
+// welford_combine, soma, mínimo, máximo e faixas), combinado com resumo_combinar; a memória
+// usada é a dos dois buffers, qualquer que seja o tamanho do arquivo, e o arquivo é lido uma
+// única vez, em ordem.
+//
+// Formatos: coluna double de um snapshot (snapshot.hpp), arquivo binário de doubles e coluna
+// de um CSV. No CSV, a última linha incompleta de cada bloco passa para o início do próximo.
+// Percentis exatos precisam dos dados inteiros; com k_esboco > 0 o resumo carrega um esboço
+// KLL (esboco_quantis.hpp), combinado junto com o resto, e os percentis saem aproximados.
+
+struct OpcoesStreaming {
+    size_t bytes_por_bloco = size_t(64) << 20;  // por buffer (são dois)
+    std::vector<double> limites;                // faixas do histograma, como em resumir_salarios
+    int k_esboco = 0;                           // > 0: esboço KLL para percentis aproximados
+    OpcoesCsv csv;
+};
+
+struct ResultadoStreaming {
+    ResumoSalarial resumo;
+    size_t blocos = 0;
+    size_t bytes = 0;
+    double segundos = 0.0;
+    double espera_leitura_s = 0.0;  // tempo em que o processamento ficou parado esperando o disco
+
+    double mb_por_s() const { return segundos > 0 ? bytes / segundos / 1e6 : 0.0; }
+};
+
+namespace detalhe_streaming {
+
+class ArquivoSequencial {
+public:
+    explicit ArquivoSequencial(const std::string& caminho) : caminho_(caminho) {
+        fd_ = open(caminho.c_str(), O_RDONLY);
+        if (fd_ < 0) throw std::runtime_error("não foi possível abrir " + caminho);
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    ArquivoSequencial(const ArquivoSequencial&) = delete;
+    ArquivoSequencial& operator=(const ArquivoSequencial&) = delete;
+    ~ArquivoSequencial() { close(fd_); }
+
+    // Lê até `bytes` a partir de `posicao`; menos que `bytes` só no fim do arquivo
+    size_t ler(char* destino, size_t bytes, uint64_t posicao) const {
+        size_t total = 0;
+        while (total < bytes) {
+            ssize_t lidos = pread(fd_, destino + total, bytes - total, static_cast<off_t>(posicao + total));
+            if (lidos < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("falha de leitura em " + caminho_);
+            }
+            if (lidos == 0) break;
+            total += static_cast<size_t>(lidos);
+        }
+        return total;
+    }
+
+private:
+    std::string caminho_;
+    int fd_ = -1;
+};
+
+inline size_t numero_faixas(const OpcoesStreaming& o) { return o.limites.empty() ? 0 : o.limites.size() - 1; }
+
+// Espera a leitura em andamento e contabiliza o tempo parado
+inline size_t aguardar(std::future<size_t>& leitura, ResultadoStreaming& r) {
+    double inicio = omp_get_wtime();
+    size_t lidos = leitura.get();
+    r.espera_leitura_s += omp_get_wtime() - inicio;
+    return lidos;
+}
+
+} // namespace detalhe_streaming
+
+// Resume `bytes` bytes de doubles a partir de `deslocamento` (padrão: até o fim do arquivo)
+inline ResultadoStreaming resumir_binario(const std::string& caminho, uint64_t deslocamento = 0,
+                                          uint64_t bytes = UINT64_MAX, const OpcoesStreaming& opcoes = {}) {
+    using namespace detalhe_streaming;
+    const double inicio = omp_get_wtime();
+    ArquivoSequencial arquivo(caminho);
+    const uint64_t fim = bytes == UINT64_MAX ? UINT64_MAX : deslocamento + bytes;
+    const size_t por_bloco = std::max<size_t>(1, opcoes.bytes_por_bloco / sizeof(double));
+
+    std::vector<double> atual(por_bloco), proximo(por_bloco);
+    auto ler = [&arquivo, fim, por_bloco](double* destino, uint64_t posicao) {
+        const size_t pedir = static_cast<size_t>(std::min<uint64_t>(por_bloco * sizeof(double), fim - posicao));
+        const size_t lidos = arquivo.ler(reinterpret_cast<char*>(destino), pedir, posicao);
+        if (lidos % sizeof(double) != 0) throw std::runtime_error("arquivo binário com tamanho que não é múltiplo de 8");
+        return lidos;
+    };
+
+    ResultadoStreaming r;
+    r.resumo = ResumoSalarial(numero_faixas(opcoes), opcoes.k_esboco);
+    uint64_t posicao = deslocamento;
+    size_t lidos = ler(atual.data(), posicao);
+    while (lidos > 0) {
+        posicao += lidos;
+        std::future<size_t> leitura = std::async(std::launch::async, ler, proximo.data(), posicao);
+        resumo_combinar(r.resumo,
+                        resumir_salarios(atual.data(), lidos / sizeof(double), opcoes.limites, opcoes.k_esboco));
+        r.bytes += lidos;
+        ++r.blocos;
+        lidos = aguardar(leitura, r);
+        std::swap(atual, proximo);
+    }
+    r.segundos = omp_get_wtime() - inicio;
+    return r;
+}
+
+// Resume uma coluna double de um snapshot lendo só os bytes dela, sem mapear o arquivo
+inline ResultadoStreaming resumir_snapshot(const std::string& caminho, const std::string& coluna,
+                                           const OpcoesStreaming& opcoes = {}) {
+    uint64_t deslocamento, bytes;
+    {
+        Snapshot snapshot(caminho);
+        const DescritorColuna& d = snapshot.descritor(coluna, TipoColuna::F64);
+        deslocamento = d.deslocamento;
+        bytes = d.bytes;
+    }
+    return resumir_binario(caminho, deslocamento, bytes, opcoes);
+}
+
+// Resume uma coluna numérica de um CSV. Cada bloco de texto é convertido em paralelo pelas
+// funções de ingestao_csv.hpp num vetor reaproveitado e resumido em seguida.
+inline ResultadoStreaming resumir_csv(const std::string& caminho, const std::string& nome_coluna,
+                                      const OpcoesStreaming& opcoes = {}) {
+    using namespace detalhe_streaming;
+    const double inicio_tempo = omp_get_wtime();
+    ArquivoSequencial arquivo(caminho);
+    const size_t capacidade = std::max<size_t>(4096, opcoes.bytes_por_bloco);
+    std::vector<char> atual(capacidade), proximo(capacidade);
+
+    uint64_t posicao = 0;
+    size_t tamanho = arquivo.ler(atual.data(), capacidade, posicao);
+    bool fim_arquivo = tamanho < capacidade;
+    posicao += tamanho;
+
+    // Cabeçalho: tem de caber no primeiro bloco
+    std::string_view texto(atual.data(), tamanho), cabecalho;
+    size_t inicio = 0;
+    if (!detalhe_csv::proxima_linha(texto, inicio, cabecalho)) throw std::runtime_error(caminho + ": CSV vazio");
+    if (inicio > tamanho && !fim_arquivo) throw std::runtime_error(caminho + ": cabeçalho maior que o bloco");
+    const int coluna = detalhe_csv::localizar_colunas(cabecalho, opcoes.csv.separador, {nome_coluna})[0];
+    if (coluna < 0) throw std::runtime_error(caminho + ": coluna " + nome_coluna + " ausente no cabeçalho");
+    inicio = std::min(inicio, tamanho);
+
+    ResultadoStreaming r;
+    r.resumo = ResumoSalarial(numero_faixas(opcoes), opcoes.k_esboco);
+    r.bytes = inicio;
+    std::vector<detalhe_csv::Bloco> blocos;
+    std::vector<double> valores;
+    size_t linha_arquivo = 2;
+
+    while (true) {
+        // Linhas completas: até o último '\n', ou o resto todo no fim do arquivo
+        size_t completo = tamanho;
+        size_t resto = 0;
+        std::future<size_t> leitura;
+        if (!fim_arquivo) {
+            const void* nl = memrchr(atual.data() + inicio, '\n', tamanho - inicio);
+            if (nl == nullptr) {
+                throw std::runtime_error(caminho + ": linha " + std::to_string(linha_arquivo) + " maior que o bloco");
+            }
+            completo = static_cast<size_t>(static_cast<const char*>(nl) - atual.data()) + 1;
+            resto = tamanho - completo;
+            std::memcpy(proximo.data(), atual.data() + completo, resto);
+            char* destino = proximo.data() + resto;
+            const size_t pedir = capacidade - resto;
+            leitura = std::async(std::launch::async, [&arquivo, destino, pedir, posicao] {
+                return arquivo.ler(destino, pedir, posicao);
+            });
+        }
+
+        size_t linhas_fisicas = 0;
+        std::string_view linhas(atual.data() + inicio, completo - inicio);
+        const size_t n = detalhe_csv::dividir_blocos(linhas, linha_arquivo, blocos, &linhas_fisicas);
+        valores.resize(n);
+        detalhe_csv::converter_coluna(blocos, opcoes.csv.separador, coluna, valores.data(), caminho);
+        resumo_combinar(r.resumo, resumir_salarios(valores.data(), n, opcoes.limites, opcoes.k_esboco));
+        linha_arquivo += linhas_fisicas;
+        r.bytes += completo - inicio;
+        ++r.blocos;
+
+        if (fim_arquivo) break;
+        const size_t lidos = aguardar(leitura, r);
+        fim_arquivo = lidos < capacidade - resto;
+        posicao += lidos;
+        tamanho = resto + lidos;
+        inicio = 0;
+        std::swap(atual, proximo);
+    }
+    r.segundos = omp_get_wtime() - inicio_tempo;
+    return r;
+}
+
+// Escolhe o leitor pelo conteúdo: snapshot (pela assinatura), CSV (extensão .csv) ou binário
+// de doubles. `coluna` vale para snapshot e CSV.
+inline ResultadoStreaming resumir_arquivo(const std::string& caminho, const std::string& coluna,
+                                          const OpcoesStreaming& opcoes = {}) {
+    char assinatura[sizeof(CabecalhoSnapshot::assinatura)] = {};
+    {
+        detalhe_streaming::ArquivoSequencial arquivo(caminho);
+        arquivo.ler(assinatura, sizeof(assinatura), 0);
+    }
+    if (std::memcmp(assinatura, detalhe_snapshot::ASSINATURA, sizeof(assinatura)) == 0) {
+        return resumir_snapshot(caminho, coluna, opcoes);
+    }
+    if (caminho.size() >= 4 && caminho.compare(caminho.size() - 4, 4, ".csv") == 0) {
+        return resumir_csv(caminho, coluna, opcoes);
+    }
+    return resumir_binario(caminho, 0, UINT64_MAX, opcoes);
+}
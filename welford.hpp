@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+
+// Estrutura para acumular estatísticas online
+struct WelfordAccumulator {
+    double mean;
+    double M2;
+    long long count;
+    
+    WelfordAccumulator() : mean(0.0), M2(0.0), count(0) {}
+};
+
+// Função para combinar acumuladores (necessária para reduction customizada)
+inline void welford_combine(WelfordAccumulator& a, const WelfordAccumulator& b) {
+    if (b.count == 0) return;
+    if (a.count == 0) {
+        a = b;
+        return;
+    }
+    
+    long long total_count = a.count + b.count;
+    double delta = b.mean - a.mean;
+    
+    a.M2 += b.M2 + delta * delta * a.count * b.count / total_count;
+    a.mean = (a.count * a.mean + b.count * b.mean) / total_count;
+    a.count = total_count;
+}
+
+// Função para atualizar acumulador com novo valor
+inline void welford_update(WelfordAccumulator& acc, double x) {
+    acc.count++;
+    double delta = x - acc.mean;
+    acc.mean += delta / acc.count;
+    double delta2 = x - acc.mean;
+    acc.M2 += delta * delta2;
+}
+
+#pragma omp declare reduction( \
+    welford_combine_reduction : \
+    WelfordAccumulator : \
+    welford_combine(omp_out, omp_in) \
+) initializer(omp_priv = WelfordAccumulator())
+
+// Welford vetorizado para um bloco contíguo: WELFORD_LANES acumuladores independentes,
+// um por lane SIMD (a lane l recebe x[l], x[l + L], x[l + 2L], ...). Como todas as lanes
+// têm a mesma contagem, a divisão por count vira uma multiplicação pelo mesmo inverso,
+// sem dependência entre lanes. No fim, as lanes são combinadas aos pares com welford_combine
+// (fórmula de Chan) e o resto do bloco entra com welford_update.
+// target_clones gera versões AVX-512, AVX2 e escalar, escolhidas na carga do programa.
+// fp-contract=off impede o GCC de fundir multiplicação e soma em FMA só no clone AVX-512
+// (o único com FMA): com contração, o resultado mudaria de bits conforme a CPU, e
+// welford_reprodutivel (soma_reprodutivel.hpp) precisa dos mesmos bits em qualquer nó.
+const int WELFORD_LANES = 8;
+
+__attribute__((target_clones("avx512f", "avx2", "default"), optimize("fp-contract=off")))
+inline WelfordAccumulator welford_bloco(const double* x, size_t n) {
+    double mean[WELFORD_LANES] = {};
+    double M2[WELFORD_LANES] = {};
+    const size_t porLane = n / WELFORD_LANES;
+
+    for (size_t j = 0; j < porLane; ++j) {
+        const double inverso = 1.0 / static_cast<double>(j + 1);
+        const double* linha = x + j * WELFORD_LANES;
+        #pragma omp simd
+        for (int l = 0; l < WELFORD_LANES; ++l) {
+            double delta = linha[l] - mean[l];
+            mean[l] += delta * inverso;
+            M2[l] += delta * (linha[l] - mean[l]);
+        }
+    }
+
+    WelfordAccumulator lanes[WELFORD_LANES];
+    for (int l = 0; l < WELFORD_LANES; ++l) {
+        lanes[l].mean = mean[l];
+        lanes[l].M2 = M2[l];
+        lanes[l].count = static_cast<long long>(porLane);
+    }
+    for (int passo = 1; passo < WELFORD_LANES; passo *= 2) {
+        for (int l = 0; l + passo < WELFORD_LANES; l += 2 * passo) {
+            welford_combine(lanes[l], lanes[l + passo]);
+        }
+    }
+
+    for (size_t i = porLane * WELFORD_LANES; i < n; ++i) {
+        welford_update(lanes[0], x[i]);
+    }
+    return lanes[0];
+}
+
+// Welford paralelo: blocos do tamanho da L1 processados por welford_bloco e
+// combinados por thread e entre threads com a reduction customizada
+inline WelfordAccumulator welford_paralelo(const double* x, size_t n) {
+    const size_t BLOCO = 4096; // 32 KiB de doubles
+    const size_t numBlocos = (n + BLOCO - 1) / BLOCO;
+    WelfordAccumulator acc;
+
+    #pragma omp parallel for schedule(static) reduction(welford_combine_reduction:acc)
+    for (size_t b = 0; b < numBlocos; ++b) {
+        const size_t inicio = b * BLOCO;
+        const size_t tamanho = (n - inicio < BLOCO) ? n - inicio : BLOCO;
+        welford_combine(acc, welford_bloco(x + inicio, tamanho));
+    }
+    return acc;
+}